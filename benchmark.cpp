@@ -97,17 +97,101 @@ struct random_gen {
   }
 };
 
+// Page cache activity, reported only when the reference is disk-resident
+template <typename Reference>
+struct paging_report {
+  static void reset(const Reference &) { }
+  static void show(const Reference &, size_t, double) { }
+};
+
+template <typename Alphabet>
+struct paging_report<rlz::paged_reference<Alphabet>> {
+  using Reference = rlz::paged_reference<Alphabet>;
+
+  static void reset(const Reference &ref)
+  {
+    ref.reset_stats();
+  }
+
+  // Parse and literals of the index stay in memory: only the reference is paged
+  static void show(const Reference &ref, size_t times, double index_mb)
+  {
+    auto s = ref.stats();
+    std::cout << "Resident       <= " << index_mb + ref.cache_bytes() / 1048576.0
+              << " MiB (index " << index_mb << " + page cache " << (ref.cache_bytes() >> 20) << ")" << std::endl;
+    std::cout << "Page faults    = " << 1.0 * s.misses / times << " per extraction ("
+              << s.misses << " total, " << s.hits << " hits, " << s.evictions << " evictions)" << std::endl;
+  }
+};
+
 class call {
 private:
   size_t length;
   size_t times;
+  bool   sorted;
+  bool   symbols;
+
+  // Annotation-like workload: the same random extractions, issued in increasing order, served
+  // by independent calls and by a single cursor.
+  template <typename Index>
+  void sorted_scan(const Index &idx)
+  {
+    using T = typename index_symbol<Index>::Type;
+    using namespace std::chrono;
+    random_gen rg(idx.size() - length);
+    std::vector<size_t> starts(times);
+    for (auto &s : starts) { s = rg(); }
+    std::sort(starts.begin(), starts.end());
+
+    std::vector<T> buffer(length);
+    auto buf_it = buffer.begin();
+    auto t_1 = high_resolution_clock::now();
+    for (auto s : starts) {
+      idx(s, s + length, buf_it);
+      GCC_TURN_OFF_DEAD_STORE_OPT(buf_it);
+    }
+    auto t_2 = high_resolution_clock::now();
+    auto cur = idx.get_cursor();
+    for (auto s : starts) {
+      cur(s, s + length, buf_it);
+      GCC_TURN_OFF_DEAD_STORE_OPT(buf_it);
+    }
+    auto t_3 = high_resolution_clock::now();
+    std::cout << "Sorted, calls  = "
+              << duration_cast<nanoseconds>((t_2 - t_1) / times).count() << "ns\n"
+              << "Sorted, cursor = "
+              << duration_cast<nanoseconds>((t_3 - t_2) / times).count() << "ns" << std::endl;
+  }
+
+  // Single-symbol access at random positions
+  template <typename Index>
+  void symbol_access(const Index &idx)
+  {
+    using T = typename index_symbol<Index>::Type;
+    using namespace std::chrono;
+    random_gen rg(idx.size());
+    std::vector<size_t> positions(times);
+    for (auto &p : positions) { p = rg(); }
+
+    T sym{};
+    auto t_1 = high_resolution_clock::now();
+    for (auto p : positions) {
+      sym = idx(p);
+      GCC_TURN_OFF_DEAD_STORE_OPT(sym);
+    }
+    auto t_2 = high_resolution_clock::now();
+    std::cout << "Symbol access  = "
+              << duration_cast<nanoseconds>((t_2 - t_1) / times).count() << "ns" << std::endl;
+  }
 public:
-  call(size_t length, size_t times) : length(length), times(times) { }
+  call(size_t length, size_t times, bool sorted, bool symbols)
+    : length(length), times(times), sorted(sorted), symbols(symbols) { }
 
   template <typename Index>
   void invoke(Index &idx)
   {
     using T = typename index_symbol<Index>::Type;
+    using Paging = paging_report<typename Index::ReferenceType>;
     using namespace std::chrono;
 
     random_gen rg(idx.size() - length);
@@ -127,6 +211,7 @@ public:
     std::vector<T> buffer(length, '0');
     auto buf_it = buffer.begin();
     performance_events pe;
+    Paging::reset(idx.get_source());
     pe.start();
     t_1 = high_resolution_clock::now();
     size_t start, end;
@@ -149,6 +234,13 @@ public:
     pe.show([&](const char *desc, long long int val) -> void {
       std::cout << desc << "\t= " << val / times << std::endl;
     });
+    Paging::show(idx.get_source(), times, sdsl::size_in_mega_bytes(idx));
+    if (sorted) {
+      sorted_scan(idx);
+    }
+    if (symbols) {
+      symbol_access(idx);
+    }
   }
 };
 
@@ -167,7 +259,15 @@ int main(int argc, char **argv)
         ("length,l", po::value<size_t>()->required(),
          "Extraction length.")
         ("times,t", po::value<size_t>()->required(),
-         "Number of extractions.");
+         "Number of extractions.")
+        ("ram-budget,m", po::value<size_t>(),
+         "Keep the reference on disk, caching at most this many MiB of it.")
+        ("page-size,p", po::value<size_t>()->default_value(65536UL),
+         "Page size (bytes) of the disk-resident reference.")
+        ("sorted,S",
+         "Also time sorted extractions, with and without an index cursor.")
+        ("symbols,a",
+         "Also time single-symbol access at random positions.");
 
     po::positional_options_description pd;
     pd.add("index-file", 1).add("reference-file", 1).add("length", 1).add("times", 1);
@@ -184,8 +284,15 @@ int main(int argc, char **argv)
     size_t length     = vm["length"].as<size_t>();
     size_t times      = vm["times"].as<size_t>();
 
-    call c { length, times };
-    rlz::serialize::load_stream(index.c_str(), reference.c_str(), c);     
+    call c { length, times, vm.count("sorted") > 0, vm.count("symbols") > 0 };
+    if (vm.count("ram-budget")) {
+      auto budget = vm["ram-budget"].as<size_t>() << 20;
+      std::cout << "RAM budget     = " << (budget >> 20) << " MiB, "
+                << vm["page-size"].as<size_t>() << " bytes per page" << std::endl;
+      rlz::serialize::load_paged(index.c_str(), reference.c_str(), budget, c, vm["page-size"].as<size_t>());
+    } else {
+      rlz::serialize::load_stream(index.c_str(), reference.c_str(), c);
+    }
   } catch (std::exception &e) {
     std::cerr << e.what() << "\n"
               << "Command-line options:"  << "\n"
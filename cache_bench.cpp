@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <api.hpp>
+#include <cached_index.hpp>
+#include <zipf_gen.hpp>
+
+struct settings {
+  size_t length;        // Extraction length
+  size_t times;         // Number of extractions
+  size_t regions;       // Number of distinct regions queried
+  double skew;          // Zipf exponent
+  size_t block_len;     // Cached window length
+  size_t cache_bytes;   // Cache budget
+  size_t seed;
+};
+
+template <typename Extractor, typename Symbol>
+double ns_per_extraction(const Extractor &e, const std::vector<size_t> &starts, size_t length, std::vector<Symbol> &buffer)
+{
+  using namespace std::chrono;
+  auto t_1 = high_resolution_clock::now();
+  for (auto s : starts) {
+    e(s, s + length, buffer.data());
+  }
+  auto t_2 = high_resolution_clock::now();
+  return 1.0 * duration_cast<nanoseconds>(t_2 - t_1).count() / starts.size();
+}
+
+class call {
+  settings s;
+public:
+  call(settings s) : s(s) { }
+
+  template <typename Index>
+  void invoke(Index &idx)
+  {
+    using Symbol = typename Index::Symbol;
+    if (idx.size() <= s.length) {
+      throw std::logic_error("Extraction length exceeds index length");
+    }
+
+    // Hot regions: random starting positions, queried with Zipf-distributed popularity
+    std::default_random_engine rg(s.seed);
+    std::uniform_int_distribution<size_t> pos(0UL, idx.size() - s.length);
+    std::vector<size_t> regions(s.regions);
+    for (auto &r : regions) { r = pos(rg); }
+    rlz::perf::zipf_gen zipf(s.regions, s.skew);
+    std::vector<size_t> starts(s.times);
+    for (auto &st : starts) { st = regions[zipf(rg)]; }
+
+    std::vector<Symbol> buffer(s.length);
+    auto plain = ns_per_extraction(idx, starts, s.length, buffer);
+
+    rlz::cached_index<Index> cached(idx, s.block_len, s.cache_bytes);
+    auto with_cache = ns_per_extraction(cached, starts, s.length, buffer);
+    auto st = cached.stats();
+
+    std::cout << "Extraction length = " << s.length << "\n"
+              << "Repetitions       = " << s.times << "\n"
+              << "Regions / skew    = " << s.regions << " / " << s.skew << "\n"
+              << "Block / cache     = " << s.block_len << " symbols / " << (s.cache_bytes >> 20) << " MiB\n"
+              << "Uncached          = " << plain << " ns\n"
+              << "Cached            = " << with_cache << " ns\n"
+              << "Block hits        = " << st.hits << "\n"
+              << "Block misses      = " << st.misses << "\n"
+              << "Hit rate          = " << 100.0 * st.hits / std::max<size_t>(1UL, st.hits + st.misses) << "%" << std::endl;
+  }
+};
+
+int main(int argc, char **argv)
+{
+  using std::string;
+  namespace po = boost::program_options;
+  po::options_description desc;
+  po::variables_map vm;
+  try {
+    desc.add_options()
+        ("index-file,i", po::value<string>()->required(),
+         "Index filename.")
+        ("reference-file,r", po::value<string>()->required(),
+         "Reference file.")
+        ("length,l", po::value<size_t>()->default_value(1000UL),
+         "Extraction length.")
+        ("times,t", po::value<size_t>()->default_value(1000000UL),
+         "Number of extractions.")
+        ("regions,n", po::value<size_t>()->default_value(100000UL),
+         "Number of distinct regions.")
+        ("skew,z", po::value<double>()->default_value(1.0),
+         "Zipf exponent of region popularity.")
+        ("block,b", po::value<size_t>()->default_value(4096UL),
+         "Length of cached blocks.")
+        ("cache,c", po::value<size_t>()->default_value(64UL),
+         "Cache size (MiB).")
+        ("seed,s", po::value<size_t>()->default_value(42UL),
+         "Random seed.");
+
+    po::positional_options_description pd;
+    pd.add("index-file", 1).add("reference-file", 1);
+
+    try {
+      po::store(po::command_line_parser(argc, argv).options(desc).positional(pd).run(), vm);
+      po::notify(vm);
+    } catch (boost::program_options::error &e) {
+      throw std::runtime_error(e.what());
+    }
+
+    settings s {
+      vm["length"].as<size_t>(), vm["times"].as<size_t>(), vm["regions"].as<size_t>(),
+      vm["skew"].as<double>(), vm["block"].as<size_t>(), vm["cache"].as<size_t>() << 20,
+      vm["seed"].as<size_t>()
+    };
+    if (s.times == 0UL or s.regions == 0UL or s.block_len == 0UL) {
+      throw std::runtime_error("Repetitions, regions and block length must be positive");
+    }
+
+    call c { s };
+    rlz::serialize::load_stream(vm["index-file"].as<string>().c_str(), vm["reference-file"].as<string>().c_str(), c);
+  } catch (std::exception &e) {
+    std::cerr << e.what() << "\n"
+              << "Command-line options:"  << "\n"
+              << desc << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rlz {
+
+// Runtime handle to a serialized index of any registered configuration.
+//
+// The per-configuration kernels are compiled once into rlz_lib, so tools linking this handle do
+// not instantiate the whole serialization registry. Symbols are exchanged as raw memory of
+// symbol_bytes() each, and dispatch is paid once per call, never once per symbol: prefer the
+// batch functions to many small extractions.
+class any_index {
+public:
+  // A phrase of the parsing, as reported by index::process_parsing
+  struct phrase {
+    std::int64_t offset;    // Reference position minus phrase start
+    size_t       copy_len;  // Length of the copied part
+    size_t       lit_len;   // Length of the literal run that follows
+  };
+
+  using range          = std::pair<size_t, size_t>;  // [begin, end)
+  using phrase_visitor = std::function<void(const phrase *, size_t)>;
+
+  class handle;
+
+  // Loads an index and its reference (raw symbols).
+  static any_index load(std::istream &index, std::istream &reference);
+  static any_index load(const char *index_file, const char *reference_file);
+
+  any_index() = default;
+
+  size_t size() const;
+
+  // Width of a symbol, in bytes
+  size_t symbol_bytes() const;
+
+  // Demangled name of the underlying index type
+  std::string type_name() const;
+
+  // Bytes taken by the serialized index (reference excluded)
+  size_t size_in_bytes() const;
+
+  // Writes symbols [begin, end) to out, which must be aligned for symbol_bytes()-wide integers.
+  void extract(size_t begin, size_t end, void *out) const;
+  std::vector<char> extract(size_t begin, size_t end) const;
+
+  // Writes the symbols of every range, concatenated, to out.
+  void extract_batch(const range *ranges, size_t n, void *out) const;
+  void extract_batch(const std::vector<range> &ranges, void *out) const;
+
+  // Streams the raw symbols [begin, end) to out, decompressing buffer_len symbols at a time.
+  void decompress_range(size_t begin, size_t end, std::ostream &out, size_t buffer_len = 1UL << 22) const;
+
+  // Calls f on consecutive chunks of at most chunk_len phrases, in text order.
+  void process_parsing(const phrase_visitor &f, size_t chunk_len = 4096UL) const;
+
+private:
+  std::shared_ptr<const handle> impl;
+
+  explicit any_index(std::shared_ptr<const handle> impl) : impl(std::move(impl)) { }
+
+  const handle &get() const;
+  void check_range(size_t begin, size_t end) const;
+};
+
+}
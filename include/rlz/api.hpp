@@ -7,10 +7,12 @@
 #include <vector>
 
 #include "alphabet.hpp"
+#include "build_stats.hpp"
 #include "classic_parse_keeper.hpp"
 #include "containers.hpp"
 #include "dumper.hpp"
 #include "impl/api.hpp"
+#include "index_format.hpp"
 #include "io.hpp"
 #include "trivial_prefix.hpp"
 #include "type_utils.hpp"
@@ -50,6 +52,7 @@ namespace api {
 
 //////////////////////////////////// BUILD FUNCTIONS ///////////////////////////////////////////
 // Reference must support operator[], begin(), end(), size() (all marked const) and a default constructor.
+// The optional bounds cap subphrase length and align blocks (see build::phrase_bounds).
 
 // Construct index starting from input (pointer to start), a Reference instance and matching statistics (pair of iterators)
 template <
@@ -62,7 +65,7 @@ template <
 >
 impl::Index<Alphabet, container_wrapper<Alphabet, Reference>, ParseKeeper, LiteralKeeper> construct_ptr(
   typename Alphabet::Symbol *input, Reference reference, ParseType parser,
-  MatchIt match_begin, MatchIt match_end
+  MatchIt match_begin, MatchIt match_end, build::phrase_bounds bounds = build::phrase_bounds()
 )
 {
   // Return index
@@ -72,7 +75,7 @@ impl::Index<Alphabet, container_wrapper<Alphabet, Reference>, ParseKeeper, Liter
     input,
     container_wrapper<Alphabet, Reference>(std::move(reference)), 
     parser,
-    match_begin, match_end
+    match_begin, match_end, bounds
   );
 }
 
@@ -86,7 +89,8 @@ template <
   typename InputIt
 >
 impl::Index<Alphabet, container_wrapper<Alphabet, Reference>, ParseKeeper, LiteralKeeper> construct_iterator(
-  InputIt input_begin, InputIt input_end, Reference reference, ParseType parser
+  InputIt input_begin, InputIt input_end, Reference reference, ParseType parser,
+  build::phrase_bounds bounds = build::phrase_bounds()
 )
 {
 
@@ -104,7 +108,7 @@ impl::Index<Alphabet, container_wrapper<Alphabet, Reference>, ParseKeeper, Liter
     input_ms.data(), 
     container_wrapper<Alphabet, Reference>(std::move(reference)),
     parser,
-    matches.begin(), matches.end()
+    matches.begin(), matches.end(), bounds
   );
 }
 
@@ -117,7 +121,8 @@ template <
   typename Reference
 >
 impl::Index<Alphabet, container_wrapper<Alphabet, Reference>, ParseKeeper, LiteralKeeper> construct_stream(
-  std::istream &input, Reference reference, ParseType parser
+  std::istream &input, Reference reference, ParseType parser,
+  build::phrase_bounds bounds = build::phrase_bounds()
 )
 {
   // Check streams
@@ -138,7 +143,7 @@ impl::Index<Alphabet, container_wrapper<Alphabet, Reference>, ParseKeeper, Liter
     input_ms.data(), 
     container_wrapper<Alphabet, Reference>(std::move(reference)),
     parser,
-    matches.begin(), matches.end()
+    matches.begin(), matches.end(), bounds
   );
 }
 
@@ -150,7 +155,8 @@ template <
   typename ParseType
 >
 impl::Index<Alphabet, mapped_stream<Alphabet>, ParseKeeper, LiteralKeeper> construct_sstream(
-  std::istream &input, std::istream &reference, ParseType parser
+  std::istream &input, std::istream &reference, ParseType parser,
+  build::phrase_bounds bounds = build::phrase_bounds()
 )
 {
   if (!input) {
@@ -170,7 +176,7 @@ impl::Index<Alphabet, mapped_stream<Alphabet>, ParseKeeper, LiteralKeeper> const
 
   return impl::construct<Alphabet, PK, LK>(
     input_ms.data(), reference_ms,
-    parser, matches.begin(), matches.end()
+    parser, matches.begin(), matches.end(), bounds
   );
 }
 
@@ -185,7 +191,8 @@ template <
 impl::Index<Alphabet, managed_wrap<Alphabet>, ParseKeeper, LiteralKeeper> construct_sstream(
   std::istream &input, std::istream &reference,
   ParseType parser,
-  MatchIt m_begin, MatchIt m_end
+  MatchIt m_begin, MatchIt m_end,
+  build::phrase_bounds bounds = build::phrase_bounds()
 )
 {
   using Symbol = typename Alphabet::Symbol;
@@ -197,13 +204,14 @@ impl::Index<Alphabet, managed_wrap<Alphabet>, ParseKeeper, LiteralKeeper> constr
     throw std::logic_error("Reference stream not readable");
   }
 
-  // Read input
-  auto input_data = rlz::io::read_stream<Symbol>(input);
+  // Read input and reference
+  instrument::scoped_stage read_stage("read");
+  size_t input_length, reference_length;
+  auto input_data = rlz::io::read_stream<Symbol>(input, &input_length);
   auto input_ptr  = input_data.get();
-
-  // Read reference
-  size_t reference_length;
   auto reference_uniq = rlz::io::read_stream<Symbol>(reference, &reference_length);
+  read_stage.add_bytes((input_length + reference_length) * sizeof(Symbol));
+  read_stage.stop();
   std::shared_ptr<Symbol> reference_shared { reference_uniq.release(), std::default_delete<Symbol[]>{} };
   managed_wrap<Alphabet> reference_wrap { reference_shared, reference_length };
 
@@ -213,7 +221,7 @@ impl::Index<Alphabet, managed_wrap<Alphabet>, ParseKeeper, LiteralKeeper> constr
   return impl::construct<Alphabet, PK, LK>(
     input_ptr, reference_wrap,
     parser,
-    m_begin, m_end
+    m_begin, m_end, bounds
   );
 }
 
@@ -225,13 +233,14 @@ template <
   typename ParseType
 >
 impl::Index<Alphabet, mapped_stream<Alphabet>, ParseKeeper, LiteralKeeper> construct_sstream(
-  const char *input_name, const char *reference_name, ParseType parser
+  const char *input_name, const char *reference_name, ParseType parser,
+  build::phrase_bounds bounds = build::phrase_bounds()
 )
 {
   std::ifstream input(input_name, std::ifstream::in);
   std::ifstream reference(reference_name, std::ifstream::in);
 
-  return construct_sstream<Alphabet, ParseKeeper, LiteralKeeper>(input, reference, parser);
+  return construct_sstream<Alphabet, ParseKeeper, LiteralKeeper>(input, reference, parser, bounds);
 }
 
 // Build index, 
@@ -245,13 +254,14 @@ template <
 impl::Index<Alphabet, managed_wrap<Alphabet>, ParseKeeper, LiteralKeeper> construct_sstream(
   const char *input_name, const char *reference_name, 
   ParseType parser,
-  MatchIt m_begin, MatchIt m_end
+  MatchIt m_begin, MatchIt m_end,
+  build::phrase_bounds bounds = build::phrase_bounds()
 )
 {
   std::ifstream input(input_name, std::ifstream::in);
   std::ifstream reference(reference_name, std::ifstream::in);
 
-  return construct_sstream<Alphabet, ParseKeeper, LiteralKeeper>(input, reference, parser, m_begin, m_end);
+  return construct_sstream<Alphabet, ParseKeeper, LiteralKeeper>(input, reference, parser, m_begin, m_end, bounds);
 }
 
 
@@ -292,8 +302,22 @@ using rlzap_confs    = type_utils::Prod<type_utils::type_list, rlzap_parse, lite
 // using lit_classic    = type_utils::type_list<api::LiteralKeeper<rlz::classic::prefix::trivial>>;
 // using rlz_confs      = type_utils::Prod<type_utils::type_list, parse_classic, lit_classic, alphabets>::type;
 
+// Sample interval enabled by the word-wise prefix kernel. Configurations added later are
+// prepended, so that IDs of already serialized indexes (assigned from the tail) are preserved.
+using wide_intvals   = type_utils::type_list<values::Size<64U>>;
+using wide_prefix    = type_utils::Prod<rlz::prefix::sampling_cumulative, literal_length, wide_intvals>::type;
+using wide_literal   = type_utils::WInst<api::LiteralKeeper, wide_prefix>::type;
+using rlzap_wide     = type_utils::Prod<type_utils::type_list, rlzap_parse, wide_literal, alphabets>::type;
+
+// Compact alphabets: DNA (2-bit literals) and plain integers. To bound compile time they are
+// registered only with the 64-element sample interval.
+using compact_alphabets = type_utils::type_list<
+                            rlz::alphabet::dna<>, rlz::alphabet::Integer<16UL>, rlz::alphabet::Integer<32UL>
+                          >;
+using compact_confs  = type_utils::Prod<type_utils::type_list, rlzap_parse, wide_literal, compact_alphabets>::type;
+
 // All configurations: old + new
-using configurations = rlzap_confs;
+using configurations = type_utils::join_lists<compact_confs, rlzap_wide, rlzap_confs>::type;
 }
 
 // Define machinery to invoke functions with supported type
@@ -304,6 +328,12 @@ template <>
 class invoke_id<type_utils::type_list<>> {
 public:
 
+  template <typename IndexAlphabet, typename IndexParse, typename IndexLiteral, typename Call>
+  void call_type(Call &)
+  {
+    throw std::logic_error("Index configuration is not registered for serialization");
+  }
+
   template <typename Call>
   void call_id(Call &c, size_t id_w)
   {
@@ -330,6 +360,20 @@ struct check<type_utils::type_list<ListParseMask, ListLiteralMask, ListAlphabet>
     std::is_same<impl::Bind<ListLiteralMask, ListAlphabet>, IndexLiteral>::value;
 };
 
+template <typename List, typename IndexAlphabet, typename IndexParse, typename IndexLiteral>
+struct is_listed : std::false_type { };
+
+template <typename Head, typename... Tail, typename IndexAlphabet, typename IndexParse, typename IndexLiteral>
+struct is_listed<type_utils::type_list<Head, Tail...>, IndexAlphabet, IndexParse, IndexLiteral>
+  : std::integral_constant<bool,
+      check<Head, IndexAlphabet, IndexParse, IndexLiteral>::value or
+      is_listed<type_utils::type_list<Tail...>, IndexAlphabet, IndexParse, IndexLiteral>::value
+    > { };
+
+// True when an index with the given (bound) components can be stored and loaded
+template <typename IndexAlphabet, typename IndexParse, typename IndexLiteral>
+using is_supported = is_listed<supported::configurations, IndexAlphabet, IndexParse, IndexLiteral>;
+
 template <typename T>
 struct caller;
 
@@ -404,11 +448,14 @@ template <typename Alphabet, typename Source, typename Parse, typename Literal>
 struct store_obj<index<Alphabet, Source, Parse, Literal>> {
   void operator()(const index<Alphabet, Source, Parse, Literal> &idx, std::ostream &stream)
   {
+    instrument::scoped_stage stage("serialize");
     auto do_work = [&] (size_t id) {
-      Id(id).save(stream);
+      auto hdr = format::write(stream, id, idx);
+      for (auto &s : hdr.sections) {
+        stage.add_bytes(s.length);
+      }
     };
     InvokeId{}.call_type<Alphabet, Parse, Literal>(do_work);
-    idx.serialize(stream);    
   }
 };
 
@@ -421,7 +468,7 @@ void store(const Index &idx, std::ostream &stream)
 template <typename Index>
 void store(const Index &idx, const char *out_file)
 {
-  std::ofstream out(out_file, std::ofstream::out);
+  std::ofstream out(out_file, std::ofstream::out | std::ofstream::binary);
   store(idx, out);
 }
 
@@ -432,9 +479,12 @@ private:
   std::istream &stream;
   Call &c;
   ReferenceFactory &ref;
+  const format::header &hdr;
+  const char *file_name;       // Sections are read concurrently from it, if not null
+  std::uint64_t base;          // Position of the header in file_name
 public:
-  loader(std::istream &stream, Call &c, ReferenceFactory &ref)
-    : stream(stream), c(c), ref(ref)
+  loader(std::istream &stream, Call &c, ReferenceFactory &ref, const format::header &hdr, const char *file_name, std::uint64_t base)
+    : stream(stream), c(c), ref(ref), hdr(hdr), file_name(file_name), base(base)
   {
 
   }
@@ -444,31 +494,113 @@ public:
   {
     using Reference = typename std::remove_cv<decltype(ref.template get<IndexAlphabet>())>::type;
     using Index = index<IndexAlphabet, Reference, IndexParse, IndexLiteral>;
+    auto reference = ref.template get<IndexAlphabet>();
+    format::check_reference(hdr, reference.size());
     Index idx;
-    idx.load(stream);
-    idx.set_source(ref.template get<IndexAlphabet>());
+    if (file_name != nullptr) {
+      format::load_sections(idx, hdr, file_name, base);
+    } else {
+      format::load_sections(idx, hdr, stream);
+    }
+    idx.set_source(std::move(reference));
     c.template invoke<Index>(idx); // In C++14 we can use generic lambdas...
   }
 };
 
+namespace detail {
+
 template <typename ReferenceFactory, typename Call>
-void load_factory(std::istream &stream, ReferenceFactory &ref, Call &c)
+void load_factory(std::istream &stream, const char *file_name, ReferenceFactory &ref, Call &c)
 {
   // Check stream
   if (!stream.good()) {
     throw std::logic_error("Input stream not readable");
   }
+  auto base = file_name != nullptr ? static_cast<std::uint64_t>(stream.tellg()) : 0UL;
+  format::read_magic(stream);
+  auto hdr = format::header::load(stream);
+  loader<Call, ReferenceFactory> load(stream, c, ref, hdr, file_name, base);
+  InvokeId{}.call_id(load, hdr.id);
+}
 
-  std::uint32_t id = Id::load(stream);
-  loader<Call, ReferenceFactory> load(stream, c, ref);
-  InvokeId{}.call_id(load, id);
 }
 
+template <typename ReferenceFactory, typename Call>
+void load_factory(std::istream &stream, ReferenceFactory &ref, Call &c)
+{
+  detail::load_factory(stream, nullptr, ref, c);
+}
+
+// As above, loading the sections of the index concurrently
 template <typename ReferenceFactory, typename Call>
 void load_factory(const char *file_name, ReferenceFactory &ref, Call &c)
 {
-  std::ifstream in(file_name, std::ofstream::in);
-  load_factory(in, ref, c);
+  std::ifstream in(file_name, std::ios_base::in | std::ios_base::binary);
+  detail::load_factory(in, file_name, ref, c);
+}
+
+// Checks header and section checksums of a stored index, without loading it.
+inline format::header verify(std::istream &stream)
+{
+  if (!stream.good()) {
+    throw std::logic_error("Input stream not readable");
+  }
+  auto hdr = format::verify(stream);
+  if (hdr.id == 0U or hdr.id > InvokeId::id) {
+    throw std::logic_error("No index found with id " + std::to_string(hdr.id));
+  }
+  return hdr;
+}
+
+inline format::header verify(const char *file_name)
+{
+  std::ifstream in(file_name, std::ios_base::binary);
+  return verify(in);
+}
+
+namespace detail {
+
+template <typename Alphabet, typename Source, typename Parse, typename Literal>
+void load_into(std::istream &stream, const char *file_name, index<Alphabet, Source, Parse, Literal> &idx)
+{
+  if (!stream.good()) {
+    throw std::logic_error("Input stream not readable");
+  }
+  size_t expected = 0UL;
+  auto get_id = [&] (size_t id) { expected = id; };
+  InvokeId{}.call_type<Alphabet, Parse, Literal>(get_id);
+
+  auto base = file_name != nullptr ? static_cast<std::uint64_t>(stream.tellg()) : 0UL;
+  format::read_magic(stream);
+  auto hdr = format::header::load(stream);
+  if (hdr.id != expected) {
+    throw std::logic_error("Stored index has a different configuration (id " + std::to_string(hdr.id) + ")");
+  }
+  if (idx.get_source().size() > 0UL) {
+    format::check_reference(hdr, idx.get_source().size());
+  }
+  if (file_name != nullptr) {
+    format::load_sections(idx, hdr, file_name, base);
+  } else {
+    format::load_sections(idx, hdr, stream);
+  }
+}
+
+}
+
+// Loads a stored index into idx, whose configuration it must have; the source is left untouched.
+// If idx already has a source, the index must have been built against a reference of its length.
+template <typename Alphabet, typename Source, typename Parse, typename Literal>
+void load_into(std::istream &stream, index<Alphabet, Source, Parse, Literal> &idx)
+{
+  detail::load_into(stream, nullptr, idx);
+}
+
+template <typename Alphabet, typename Source, typename Parse, typename Literal>
+void load_into(const char *file_name, index<Alphabet, Source, Parse, Literal> &idx)
+{
+  std::ifstream in(file_name, std::ios_base::in | std::ios_base::binary);
+  detail::load_into(in, file_name, idx);
 }
 
 template <typename Alphabet, typename Reference, typename Call>
@@ -495,9 +627,20 @@ void load_stream(std::istream &index, std::istream &reference, Call &c)
 template <typename Call>
 void load_stream(const char *index_name, const char *reference_name, Call &c)
 {
-  std::ifstream index(index_name, std::ofstream::in);
   std::ifstream reference(reference_name, std::ofstream::in);
-  load_stream(index, reference, c);
+  impl::stream_factory factory{reference};
+  load_factory(index_name, factory, c);
+}
+
+// Loads the index, leaving the reference on disk: it is read in pages of page_bytes through a
+// cache holding at most ram_budget bytes. Call receives an index whose Source is a paged_reference.
+// The parse and the literals are loaded in memory as usual, so the resident memory is ram_budget
+// plus the size of the index; see paged_reference for why they are not paged.
+template <typename Call>
+void load_paged(const char *index_name, const char *reference_name, size_t ram_budget, Call &c, size_t page_bytes = 1UL << 16)
+{
+  impl::paged_factory factory{reference_name, ram_budget, page_bytes};
+  load_factory(index_name, factory, c);
 }
 
 template <typename Alphabet, typename Iterator, typename Call>
@@ -510,8 +653,8 @@ void load_iterator(std::istream &index, Iterator ref_begin, Iterator ref_end, Ca
 template <typename Alphabet, typename Iterator, typename Call>
 void load_iterator(const char *index_filename, Iterator ref_begin, Iterator ref_end, Call &c)
 {
-  std::ifstream index(index_filename, std::ofstream::in);
-  load_iterator<Alphabet>(index, ref_begin, ref_end, c);
+  impl::iterator_factory<Alphabet, Iterator> factory{ref_begin, ref_end};
+  load_factory(index_filename, factory, c);
 }
 
 }
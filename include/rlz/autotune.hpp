@@ -0,0 +1,161 @@
+#pragma once
+
+#include "match.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace rlz { namespace tune {
+
+// Shape of a parse, as the coordinator commits it to the parse and literal keepers. Block
+// decisions depend on DiffSize only and literal splits on the literal width only, so a single
+// parse gives the extraction cost of every literal width and sample interval. Feed it the parser
+// events.
+class parse_stats {
+  std::int64_t diff_lo;
+  std::int64_t diff_hi;
+  std::int64_t block_delta;
+  bool         first;
+  bool         after_copy;
+
+public:
+  size_t symbols;
+  size_t copies;                    // Non-empty copies, one subphrase each
+  size_t blocks;                    // Subphrases with an absolute pointer
+  size_t literals;                  // Literal symbols
+  std::map<size_t, size_t> runs;    // Length -> number of literal runs following a copy
+  std::map<size_t, size_t> bare;    // Length -> number of literal runs not following a copy
+
+  explicit parse_stats(size_t diff_bits)
+    : diff_lo(-(1LL << (diff_bits - 1))), diff_hi((1LL << (diff_bits - 1)) - 1), block_delta(0),
+      first(true), after_copy(false), symbols(0UL), copies(0UL), blocks(0UL), literals(0UL)
+  { }
+
+  void copy(size_t position, size_t ptr, size_t len)
+  {
+    auto delta = static_cast<std::int64_t>(ptr) - static_cast<std::int64_t>(position);
+    if (first or delta - block_delta < diff_lo or delta - block_delta > diff_hi) {
+      block_delta = delta;
+      ++blocks;
+    }
+    first      = false;
+    after_copy = true;
+    symbols   += len;
+    ++copies;
+  }
+
+  void literal(size_t, size_t len)
+  {
+    if (after_copy) {
+      ++runs[len];
+    } else {
+      if (first) {      // Empty copy of delta 0 opening the first block
+        block_delta = 0;
+        ++blocks;
+      }
+      ++bare[len];
+    }
+    first      = false;
+    after_copy = false;
+    symbols   += len;
+    literals  += len;
+  }
+
+  // Subphrases when literal lengths take lit_bits: longer runs continue in empty-copy subphrases
+  size_t subphrases(size_t lit_bits) const
+  {
+    const size_t max_run = (1UL << lit_bits) - 1UL;
+    auto to_ret = copies;
+    for (auto &r : runs) {
+      to_ret += r.second * ((r.first - 1UL) / max_run);
+    }
+    for (auto &r : bare) {
+      to_ret += r.second * ((r.first + max_run - 1UL) / max_run);
+    }
+    return to_ret;
+  }
+};
+
+// Relative extraction cost, in units of one subphrase decode
+struct cost_weights {
+  double locate     = 1.0;    // Rank/select locating the first subphrase
+  double subphrase  = 1.0;    // Pointer and literal length of each subphrase touched
+  double word       = 0.25;   // Each 64-bit word scanned by the literal prefix sum
+};
+
+struct estimate {
+  double bits;    // Encoded size
+  double cost;    // Extraction of a range, relative units
+};
+
+// Extraction cost of a range of extract_len symbols for a parse summary, with literal lengths of
+// lit_bits sampled every sample subphrases. Sizes come from size_estimator.
+inline double extraction_cost(
+  const parse_stats &p, size_t lit_bits, size_t sample, size_t extract_len, const cost_weights &w = cost_weights()
+)
+{
+  const double subs = std::max<size_t>(1UL, p.subphrases(lit_bits));
+  const double n    = std::max<size_t>(1UL, p.symbols);
+  auto touched      = 1.0 + extract_len * subs / n;
+  return w.locate + touched * w.subphrase + w.word * (sample * lit_bits / 128.0);
+}
+
+// Windows of the input to parse when tuning: count windows, evenly spaced, sample symbols overall
+inline std::vector<std::pair<size_t, size_t>> sample_windows(size_t n, size_t sample, size_t count = 16UL)
+{
+  std::vector<std::pair<size_t, size_t>> to_ret;
+  if (sample >= n) {
+    to_ret.emplace_back(0UL, n);
+    return to_ret;
+  }
+  auto len = std::max<size_t>(1UL, sample / count);
+  for (auto i = 0UL; i < count; ++i) {
+    auto b = i * (n / count);
+    to_ret.emplace_back(b, std::min(n, b + len));
+  }
+  return to_ret;
+}
+
+// Matching statistics of [b, e), with matches clipped at e so that the window parses on its own
+template <typename MatchIt>
+std::vector<match> window(MatchIt matches, size_t b, size_t e)
+{
+  std::vector<match> to_ret(std::next(matches, b), std::next(matches, e));
+  for (auto i = 0UL; i < to_ret.size(); ++i) {
+    to_ret[i].len = std::min(to_ret[i].len, to_ret.size() - i);
+  }
+  return to_ret;
+}
+
+// Candidates not dominated in (bits, cost), by increasing size
+template <typename Candidate>
+std::vector<Candidate> pareto_front(std::vector<Candidate> candidates)
+{
+  std::sort(candidates.begin(), candidates.end(), [] (const Candidate &a, const Candidate &b) {
+    return a.est.bits < b.est.bits or (a.est.bits == b.est.bits and a.est.cost < b.est.cost);
+  });
+  std::vector<Candidate> front;
+  for (auto &c : candidates) {
+    if (front.empty() or c.est.cost < front.back().est.cost) {
+      front.push_back(c);
+    }
+  }
+  return front;
+}
+
+// Cheapest point of the front whose size is within (1 + slack) of the smallest one
+template <typename Candidate>
+const Candidate &choose(const std::vector<Candidate> &front, double slack)
+{
+  auto budget = front.front().est.bits * (1.0 + slack);
+  auto best   = front.begin();
+  for (auto it = front.begin(); it != front.end() and it->est.bits <= budget; ++it) {
+    best = it;
+  }
+  return *best;
+}
+
+} }
@@ -13,6 +13,7 @@
 
 #include "bitsets.hpp"
 #include "impl/bit_vectors.hpp"
+#include "sdsl_extensions/interleaved_vector.hpp"
 #include "sdsl_extensions/sd_vector.hpp"
 #include "type_name.hpp"
 #include "type_utils.hpp"
@@ -184,6 +185,49 @@ public:
 
 };
 
+// Plain bits with rank/select metadata interleaved (see sdsl::extensions::interleaved_vector)
+class interleaved : public base<sdsl::extensions::interleaved_vector>
+{
+private:
+  using Rep = sdsl::extensions::interleaved_vector;
+
+  template <typename It>
+  Rep build(const std::tuple<It, It, size_t> &pack)
+  {
+    It begin, end;
+    size_t len;
+    std::tie(begin, end, len) = pack;
+    sdsl::bit_vector bv(len, 0);
+    for (auto it = begin; it != end; ++it) {
+      bv[*it] = 1;
+    }
+    return Rep(bv);
+  }
+public:
+
+  using builder = builders::dense;
+
+  template <typename It>
+  interleaved(const std::tuple<It, It, size_t> &pack) : base<Rep>(build(pack)) { }
+
+  // Bitvector (SFINAE to select this only when we pass a BitVector)
+  template <typename BitVector, typename = rlz::impl::if_same<BitVector, sdsl::bit_vector>>
+  interleaved(BitVector &&bv) : base<Rep>(Rep(bv)) { }
+
+  interleaved() { }
+  interleaved(const interleaved &other) = default;
+  interleaved(interleaved &&other) = default;
+  interleaved &operator=(const interleaved &other) = default;
+  interleaved &operator=(interleaved &&other) = default;
+
+  template <typename R>
+  void set(R &&r)
+  {
+    interleaved temp(r.get());
+    std::swap(*this, temp);
+  }
+};
+
 ////////////////////////////////// ALGORITHMS /////////////////////////////////
 namespace algorithms {
 
@@ -536,6 +580,24 @@ struct instantiate_algo<algorithms::bitset, bit_vector<dense, L...>>
   using type = algorithms::bitset<algorithms::bitsets::dense<bit_vector<dense, L...>>>;
 };
 
+template <typename... L>
+struct instantiate_algo<algorithms::rank, bit_vector<interleaved, L...>>
+{
+  using type = algorithms::rank<sdsl::extensions::rank_support_interleaved>;
+};
+
+template <typename... L>
+struct instantiate_algo<algorithms::select, bit_vector<interleaved, L...>>
+{
+  using type = algorithms::select<sdsl::extensions::select_support_interleaved>;
+};
+
+template <typename... L>
+struct instantiate_algo<algorithms::bitset, bit_vector<interleaved, L...>>
+{
+  using type = algorithms::bitset<algorithms::bitsets::dense<bit_vector<interleaved, L...>>>;
+};
+
 template <template <typename...> class Algorithm, typename Bv>
 using InstantiateAlgo = typename instantiate_algo<Algorithm, Bv>::type;
 
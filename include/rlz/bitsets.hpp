@@ -3,12 +3,13 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
-#include <unordered_map>
 
 #include <boost/iterator/iterator_facade.hpp>
 
 #include <sdsl/bit_vectors.hpp>
 #include <sdsl/bits.hpp>
+#include <sdsl/int_vector.hpp>
+#include <sdsl/io.hpp>
 
 #include "sdsl_extensions/sd_vector.hpp"
 
@@ -16,32 +17,61 @@ namespace rlz { namespace vectors { namespace algorithms { namespace bitsets {
 
 namespace detail {
 
+// Flat skip table over 512-bit blocks: for every block, the first block at or after it holding
+// a set bit. An iterator scanning an empty block-aligned word jumps straight to that block.
+// Stored next to the bitset, so that loading an index does not scan its bitsets again.
 class dense_bv_next {
-  const std::unordered_map<size_t, size_t> *map;
+  static const constexpr size_t block_words = 8UL;
+  static const constexpr size_t block_bits  = 64UL * block_words;
+  sdsl::int_vector<> next_block;  // next_block.size() when no block follows
+  size_t             end;
 public:
 
-  dense_bv_next() { }
+  dense_bv_next() : end(0UL) { }
 
-  dense_bv_next(const std::unordered_map<size_t, size_t> *map) : map(map) { }
-
-  size_t operator()(size_t pos, size_t) const
+  template <typename BitVector>
+  explicit dense_bv_next(const BitVector &bv) : end(bv.size())
   {
-    assert(map->find(pos) != map->end());
-    return (map->find(pos))->second;
+    auto blocks = (end + block_bits - 1) / block_bits;
+    if (blocks == 0UL) { return; }
+    next_block = sdsl::int_vector<>(blocks, blocks, sdsl::bits::hi(blocks) + 1);
+    auto following = blocks;
+    for (auto b = blocks; b-- > 0; ) {
+      for (auto pos = b * block_bits; pos < std::min(end, (b + 1) * block_bits); pos += 64UL) {
+        if (bv.get_int(pos, std::min(64UL, end - pos)) != 0U) {
+          following = b;
+          break;
+        }
+      }
+      next_block[b] = following;
+    }
   }
-};
 
-struct dense_bv_next_builder {
-  mutable size_t first;
-  mutable size_t last;
+  size_t operator()(size_t pos, size_t bitset_len) const
+  {
+    auto first = pos + 1;
+    auto block = first / block_bits;
+    if ((first % block_bits) != 0 or block >= next_block.size() or next_block[block] == block) {
+      return pos + bitset_len;
+    }
+    auto target = next_block[block];
+    return (target == next_block.size()) ? end - 1 : target * block_bits - 1;
+  }
 
-  dense_bv_next_builder() : first(0UL), last(0UL) { }
+  size_t serialize(std::ostream& out, sdsl::structure_tree_node* v=nullptr, std::string name="") const
+  {
+    auto child          = sdsl::structure_tree::add_child(v, name, "dense_bv_next");
+    size_t written_bytes = 0;
+    written_bytes += next_block.serialize(out, child, "next_block");
+    written_bytes += sdsl::write_member(end, out, child, "end");
+    sdsl::structure_tree::add_size(child, written_bytes);
+    return written_bytes;
+  }
 
-  size_t operator()(size_t pos, size_t bitset_len) const
+  void load(std::istream& in)
   {
-    first = (first == 0) ? pos : first;
-    last  = pos + bitset_len;
-    return last;
+    next_block.load(in);
+    sdsl::read_member(end, in);
   }
 };
 
@@ -143,52 +173,30 @@ private:
 
 };
 
-template <typename BitVector>
-std::unordered_map<size_t, size_t> compute_accelerated_map(const BitVector &bv)
-{
-  std::unordered_map<size_t, size_t> map;
-  if (bv.size() == 0) { return map; }
-  // Get iterator on hi bits
-  using Iter  = bit_set_iterator<BitVector, dense_bv_next_builder>;
-  dense_bv_next_builder dn_build;
-  Iter iter_beg(&bv, typename Iter::position(0U), &dn_build);
-  Iter iter_end(&bv, typename Iter::position(bv.size()), &dn_build);
-
-  while (iter_beg != iter_end) {
-    ++iter_beg;
-    if (dn_build.last != 0UL) {
-      map[dn_build.first] = dn_build.last;
-      dn_build = dense_bv_next_builder{};
-    }
-  }
-  return map;
-}
   
 }
 
 template <typename BvType>
 class dense {
 private:
-  BvType                              *bv;
-  std::unordered_map<size_t, size_t>  distant_blocks;
-  detail::dense_bv_next               dbn;
+  BvType                *bv;
+  detail::dense_bv_next dbn;
 
 public:
 
   template <typename Bv>
   void init(Bv *bv)
   {
-    distant_blocks = detail::compute_accelerated_map(bv->data());
+    dbn      = detail::dense_bv_next(bv->data());
     this->bv = bv;
   }
 
   void copy(BvType *bv)
   { 
     this->bv = bv;
-    dbn = detail::dense_bv_next(&distant_blocks);
   }
 
-  dense() : dbn(&distant_blocks) { }
+  dense() : bv(nullptr) { }
 
   using iterator = detail::bit_set_iterator<BvType, detail::dense_bv_next>;
 
@@ -204,13 +212,14 @@ public:
 
   size_t serialize(std::ostream& out, sdsl::structure_tree_node* v=nullptr, std::string name="") const
   {
-    return 0UL;
+    return dbn.serialize(out, v, "bitset skips");
   }
 
   template <typename Bv_Type>
   void load(std::istream& in, Bv_Type *bv)
   {
-    init(bv);
+    dbn.load(in);
+    this->bv = bv;
   }
 };
 
@@ -226,8 +235,8 @@ private:
   size_t    idx;       // Index of current element
   LowIter   low_iter;  // Iterator of low bits
   HighIter  high_iter; // Iterator of high bits
-  const size_t  m_lw;  // Length of low bits
-  const size_t  end;   // One past maximum position in the bitvector
+  size_t    m_lw;      // Length of low bits
+  size_t    end;       // One past maximum position in the bitvector
 
   size_t current_value;
 
@@ -286,21 +295,20 @@ private:
 template <typename SparseBV>
 class sparse {
 private:
-  SparseBV                           *sbv;
-  std::unordered_map<size_t, size_t> long_phrases_hi_bits;
-  detail::dense_bv_next              dbn;
+  SparseBV              *sbv;
+  detail::dense_bv_next dbn;   // Skips over the high bits of the Elias-Fano representation
 public:
+  sparse() : sbv(nullptr) { }
+
   void init(SparseBV *bv_)
   {
     sbv = bv_;
-    long_phrases_hi_bits = detail::compute_accelerated_map(sbv->data().m_high);
-    dbn = detail::dense_bv_next(&long_phrases_hi_bits);
+    dbn = detail::dense_bv_next(sbv->data().m_high);
   }
 
   void copy(SparseBV *bv)
   {
     sbv = bv; 
-    dbn = detail::dense_bv_next(&long_phrases_hi_bits);
   }
   using iterator = detail::sparse_iterator;
 
@@ -316,13 +324,14 @@ public:
 
   size_t serialize(std::ostream& out, sdsl::structure_tree_node* v=nullptr, std::string name="") const
   {
-    return 0UL;
+    return dbn.serialize(out, v, "bitset skips");
   }
 
   template <typename Bv_Type>
   void load(std::istream& in, Bv_Type *bv)
   {
-    init(bv);
+    dbn.load(in);
+    sbv = bv;
   }
 };
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -48,6 +49,59 @@ public:
   virtual void finish() = 0;
 };
 
+// Build-time bounds on the shape of the parse. A zero disables the bound.
+struct phrase_bounds {
+  size_t max_len;     // No subphrase longer than this, in symbols
+  size_t block_len;   // A new block (absolute pointer) starts at every multiple of this
+  size_t origin;      // Position of the first parsed symbol in the whole input
+
+  phrase_bounds(size_t max_len = 0UL, size_t block_len = 0UL)
+    : max_len(max_len), block_len(block_len), origin(0UL) { }
+
+  bool any() const { return max_len > 0UL or block_len > 0UL; }
+
+  // The same bounds, for a parse of the input starting at position origin: block multiples stay
+  // those of the whole input
+  phrase_bounds at(size_t origin) const
+  {
+    auto to_ret   = *this;
+    to_ret.origin = origin;
+    return to_ret;
+  }
+};
+
+// Enforces phrase_bounds: splits phrases longer than max_len or crossing a multiple of
+// block_len, and makes the subphrase starting there an absolute one.
+template <typename Alphabet, typename SymbolIt = typename Alphabet::Symbol*>
+class phrase_limit : public observer<Alphabet, SymbolIt> {
+private:
+  const phrase_bounds bounds;
+
+public:
+  phrase_limit(phrase_bounds bounds) : bounds(bounds) { }
+
+  size_t can_split(size_t source, size_t, size_t len, size_t junk_len, const SymbolIt) override
+  {
+    auto to_ret = len + junk_len;
+    if (bounds.max_len > 0UL) {
+      to_ret = std::min(to_ret, bounds.max_len);
+    }
+    if (bounds.block_len > 0UL) {
+      to_ret = std::min(to_ret, bounds.block_len - (bounds.origin + source) % bounds.block_len);
+    }
+    return to_ret;
+  }
+
+  bool split_as_block(size_t source, size_t, size_t, size_t, const SymbolIt) override
+  {
+    return bounds.block_len > 0UL and (bounds.origin + source) % bounds.block_len == 0UL;
+  }
+
+  void split(size_t, size_t, size_t, size_t, const SymbolIt, bool) override { }
+
+  void finish() override { }
+};
+
 template <typename Agnostic, typename Alphabet, typename SymbolIt = typename Alphabet::Symbol*>
 class forward_observer_adapter : public observer<Alphabet, SymbolIt> {
 private:
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <iterator>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace rlz { namespace instrument {
+
+struct stage_stats {
+  std::string name;
+  size_t      calls;
+  double      wall_ms;
+  double      cpu_ms;      // Process CPU time: includes every thread working during the stage
+  size_t      bytes;       // Bytes processed, as reported by the stage
+  size_t      rss_growth;  // Resident set growth across the stage (0 if it shrank)
+  size_t      peak_rss;    // Process high-water mark at the end of the stage
+};
+
+namespace impl {
+
+inline double cpu_ms()
+{
+  timespec ts;
+  ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+inline size_t current_rss()
+{
+  long pages = 0L, resident = 0L;
+  auto f = std::fopen("/proc/self/statm", "r");
+  if (f == nullptr) {
+    return 0UL;
+  }
+  if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+    resident = 0L;
+  }
+  std::fclose(f);
+  return static_cast<size_t>(resident) * ::sysconf(_SC_PAGESIZE);
+}
+
+inline size_t peak_rss()
+{
+  rusage ru;
+  ::getrusage(RUSAGE_SELF, &ru);
+  return static_cast<size_t>(ru.ru_maxrss) * 1024UL;   // Linux reports KiB
+}
+
+}
+
+// Process-wide collection of build stages. Disabled by default: scoped_stage then costs a single
+// flag check, so the library stays instrumented at no measurable cost.
+class registry {
+  std::atomic<bool>         on;
+  mutable std::mutex        lock;
+  std::vector<stage_stats>  recorded;   // In order of first occurrence
+
+  registry() : on(false) { }
+
+public:
+  registry(const registry&) = delete;
+  registry &operator=(const registry&) = delete;
+
+  static registry &global()
+  {
+    static registry r;
+    return r;
+  }
+
+  void enable(bool enabled = true) { on = enabled; }
+  bool enabled() const { return on.load(std::memory_order_relaxed); }
+
+  // Repeated stages accumulate into the same entry
+  void record(const char *name, double wall_ms, double cpu_ms, size_t bytes, size_t rss_growth, size_t peak_rss)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = std::find_if(recorded.begin(), recorded.end(), [&] (const stage_stats &s) { return s.name == name; });
+    if (it == recorded.end()) {
+      recorded.push_back(stage_stats { name, 0UL, 0.0, 0.0, 0UL, 0UL, 0UL });
+      it = std::prev(recorded.end());
+    }
+    ++it->calls;
+    it->wall_ms    += wall_ms;
+    it->cpu_ms     += cpu_ms;
+    it->bytes      += bytes;
+    it->rss_growth += rss_growth;
+    it->peak_rss    = std::max(it->peak_rss, peak_rss);
+  }
+
+  std::vector<stage_stats> stages() const
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    return recorded;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    recorded.clear();
+  }
+
+  void print_table(std::ostream &out) const
+  {
+    auto st = stages();
+    out << std::left << std::setw(16) << "Stage" << std::right
+        << std::setw(7)  << "Calls"
+        << std::setw(12) << "Wall (ms)"
+        << std::setw(12) << "CPU (ms)"
+        << std::setw(12) << "MiB"
+        << std::setw(12) << "MiB/s"
+        << std::setw(14) << "RSS +MiB"
+        << std::setw(14) << "Peak MiB" << "\n";
+    out << std::fixed << std::setprecision(1);
+    for (auto &s : st) {
+      auto mib = s.bytes / 1048576.0;
+      out << std::left << std::setw(16) << s.name << std::right
+          << std::setw(7)  << s.calls
+          << std::setw(12) << s.wall_ms
+          << std::setw(12) << s.cpu_ms
+          << std::setw(12) << mib
+          << std::setw(12) << (s.wall_ms > 0.0 ? mib * 1e3 / s.wall_ms : 0.0)
+          << std::setw(14) << s.rss_growth / 1048576.0
+          << std::setw(14) << s.peak_rss / 1048576.0 << "\n";
+    }
+    out << std::defaultfloat << std::flush;
+  }
+
+  void print_json(std::ostream &out) const
+  {
+    auto st = stages();
+    out << "{ \"stages\": [";
+    for (auto i = 0UL; i < st.size(); ++i) {
+      auto &s = st[i];
+      out << (i > 0 ? ",\n" : "\n")
+          << "  { \"name\": \"" << s.name << "\", \"calls\": " << s.calls
+          << ", \"wall_ms\": " << s.wall_ms << ", \"cpu_ms\": " << s.cpu_ms
+          << ", \"bytes\": " << s.bytes << ", \"rss_growth_bytes\": " << s.rss_growth
+          << ", \"peak_rss_bytes\": " << s.peak_rss << " }";
+    }
+    out << "\n] }" << std::endl;
+  }
+};
+
+// Times the enclosing scope as a build stage of the global registry, if enabled.
+class scoped_stage {
+  const char  *name;
+  bool        active;
+  size_t      bytes;
+  size_t      rss_start;
+  double      cpu_start;
+  std::chrono::steady_clock::time_point wall_start;
+
+public:
+  explicit scoped_stage(const char *name, size_t bytes = 0UL)
+    : name(name), active(registry::global().enabled()), bytes(bytes), rss_start(0UL), cpu_start(0.0)
+  {
+    if (active) {
+      rss_start  = impl::current_rss();
+      cpu_start  = impl::cpu_ms();
+      wall_start = std::chrono::steady_clock::now();
+    }
+  }
+
+  scoped_stage(const scoped_stage&) = delete;
+  scoped_stage &operator=(const scoped_stage&) = delete;
+
+  void add_bytes(size_t b) { bytes += b; }
+
+  // Ends the stage before the end of the scope
+  void stop()
+  {
+    if (active) {
+      auto wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+      auto cpu  = impl::cpu_ms() - cpu_start;
+      auto rss  = impl::current_rss();
+      registry::global().record(name, wall, cpu, bytes, rss > rss_start ? rss - rss_start : 0UL, impl::peak_rss());
+      active = false;
+    }
+  }
+
+  ~scoped_stage() { stop(); }
+};
+
+} }
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "sharded_lru.hpp"
+
+namespace rlz {
+
+// Decoded-block cache in front of an index: the text is split in windows of block_len symbols,
+// decoded on first access and kept in a sharded LRU. Requests falling in cached windows are
+// served by copying, without touching the parse. The wrapped index must outlive the cache.
+template <typename Index>
+class cached_index {
+public:
+  using AlphabetType  = typename Index::AlphabetType;
+  using Symbol        = typename Index::Symbol;
+  using ReferenceType = typename Index::ReferenceType;
+  using size_type     = size_t;
+
+private:
+  using block = std::vector<Symbol>;
+
+  const Index                                 *idx;
+  size_t                                       block_len;
+  size_t                                       bypass_blocks;
+  mutable cache::sharded_lru<size_t, block>    blocks;
+
+  std::shared_ptr<const block> get_block(size_t b) const
+  {
+    return blocks.get(b, [&] {
+      auto begin = b * block_len;
+      return (*idx)(begin, std::min(begin + block_len, idx->size()));
+    });
+  }
+
+  // Blocks that fit in cache_bytes; the cache keeps at least one block per shard, so there are
+  // never more shards than blocks.
+  static size_t budget_blocks(size_t cache_bytes, size_t block_len)
+  {
+    return cache_bytes / std::max<size_t>(1UL, block_len * sizeof(Symbol));
+  }
+
+public:
+  // Keeps at most cache_bytes of decoded text. Ranges spanning more than bypass_blocks windows
+  // are decoded directly, so that long scans do not flush the hot blocks.
+  cached_index(const Index &idx, size_t block_len, size_t cache_bytes, size_t bypass_blocks = 8UL, size_t shards = 16UL)
+    : idx(&idx), block_len(block_len), bypass_blocks(bypass_blocks),
+      blocks(budget_blocks(cache_bytes, block_len), std::min(shards, budget_blocks(cache_bytes, block_len)))
+  {
+    if (block_len == 0UL) {
+      throw std::logic_error("Cached blocks must be non-empty");
+    }
+  }
+
+  template <typename OutputIt>
+  void operator()(size_t begin, size_t end, OutputIt out) const
+  {
+    if (begin >= end) {
+      return;
+    }
+    auto first = begin / block_len;
+    auto last  = (end - 1) / block_len;
+    if (last - first >= bypass_blocks) {
+      (*idx)(begin, end, out);
+      return;
+    }
+    for (auto b = first; b <= last; ++b) {
+      auto blk  = get_block(b);
+      auto base = b * block_len;
+      auto from = std::max(begin, base) - base;
+      auto to   = std::min(end, base + block_len) - base;
+      out = std::copy(blk->data() + from, blk->data() + to, out);
+    }
+  }
+
+  Symbol operator()(size_t i) const
+  {
+    return (*get_block(i / block_len))[i % block_len];
+  }
+
+  std::vector<Symbol> operator()(size_t begin, size_t end) const
+  {
+    std::vector<Symbol> to_ret(end - begin);
+    (*this)(begin, end, to_ret.data());
+    return to_ret;
+  }
+
+  size_t size() const { return idx->size(); }
+
+  const Index &base() const { return *idx; }
+
+  cache::lru_stats stats() const { return blocks.stats(); }
+  void reset_stats() { blocks.reset_stats(); }
+  void clear() { blocks.clear(); }
+};
+
+}
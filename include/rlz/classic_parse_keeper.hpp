@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <type_traits>
+
 #include "bit_vectors.hpp"
 #include "build_coordinator.hpp"
 #include "int_vector.hpp"
@@ -7,6 +10,8 @@
 
 #include <boost/iterator/transform_iterator.hpp>
 
+#include <sdsl/bits.hpp>
+
 namespace rlz { namespace classic {
 
 template <
@@ -23,6 +28,17 @@ private:
   PhraseBV                            pbv;
   SubphraseBV                         sbv;
   ds::int_vector<PtrSize::value()>    ptrs;
+
+  size_t next_start(size_t, size_t subphrase, std::true_type) const
+  {
+    return start_subphrase(subphrase + 1);
+  }
+
+  size_t next_start(size_t position, size_t subphrase, std::false_type) const
+  {
+    auto word = sbv.get_int(position, std::min<size_t>(64UL, sbv.size() - position));
+    return word != 0 ? position + sdsl::bits::lo(word) + 1UL : start_subphrase(subphrase + 1);
+  }
 public:
   using ptr_type = std::int64_t;
   static constexpr const size_t ptr_size = PtrSize::value();
@@ -39,6 +55,16 @@ public:
     return std::make_tuple(phr, sub);
   }
 
+  size_t subphrase(size_t position) const
+  {
+    return sbv.rank_1(position);
+  }
+
+  size_t phrase(size_t subphrase) const
+  {
+    return pbv.rank_1(subphrase);
+  }
+
   // Returns the differential pointer associated to the (phrase, subphrase) couple
   ptr_type get_ptr(size_t phrase, size_t) const
   {
@@ -48,6 +74,12 @@ public:
     return ptrs[phrase];
   }
 
+  // Whether the subphrase starts a block, that is, has an absolute pointer
+  bool starts_block(size_t subphrase) const
+  {
+    return subphrase == 0 or pbv[subphrase - 1UL] == 1;
+  }
+
   size_t start_subphrase(size_t subphrase) const
   {
     // sbv has a sentinel 1 past the end of the bitstream, so it's safe to get the length
@@ -55,6 +87,12 @@ public:
     return subphrase != 0 ? sbv.select_1(subphrase) + 1UL : 0;
   }
 
+  // Start of the subphrase following the one holding position (see parse_keeper)
+  size_t next_subphrase_start(size_t position, size_t subphrase) const
+  {
+    return next_start(position, subphrase, std::is_base_of<vectors::sparse, SubphraseBV>{});
+  }
+
   iterator get_iterator(size_t phrase_index, size_t subphrase_idx) const
   {
     return iterator(this, phrase_index, subphrase_idx);
@@ -7,6 +7,7 @@
 
 #include "bit_vectors.hpp"
 #include "check_random.hpp"
+#include "int_vector.hpp"
 #include "integer_type.hpp"
 #include "prefix_sum.hpp"
 #include "sparse_dense_vector.hpp"
@@ -80,6 +81,29 @@ public:
     n_marker = vectors::sd_bitvector<BlockSize>(markers.begin(), markers.end(), literals.size());
   }
 
+  // Packs literals as they come: 2 bits per base, plus the (sparse) positions of Ns.
+  class builder {
+    ds::growable<sdsl::extensions::int_vector<2U>> literals;
+    std::vector<size_t> markers;
+  public:
+    template <typename JunkIt>
+    void append(JunkIt begin, JunkIt end)
+    {
+      for (auto it = begin; it != end; ++it) {
+        if (*it == Nref) { markers.push_back(literals.size()); }
+        literals.push_back(to_bit{}(*it));
+      }
+    }
+
+    dna_pack get()
+    {
+      dna_pack to_ret;
+      to_ret.literals = literals.get();
+      to_ret.n_marker = vectors::sd_bitvector<BlockSize>(markers.begin(), markers.end(), to_ret.literals.size());
+      return to_ret;
+    }
+  };
+
   iterator from(size_t idx) const
   {
     auto zip_it  = boost::make_zip_iterator(boost::make_tuple(
@@ -27,7 +27,7 @@ class fractional_byte_container {
 
 public:
 
-  fractional_byte_container() { }
+  fractional_byte_container() : elements(0U) { }
 
   template <typename It>
   fractional_byte_container(It begin, It end) 
@@ -47,6 +47,22 @@ public:
 
   class iter;
 
+  void push_back(std::uint8_t value)
+  {
+    assert(value <= max_size);
+    auto shift = bits * (elements % elements_per_byte);
+    if (shift == 0U) {
+      storage.push_back(0U);
+    }
+    storage.back() |= value << shift;
+    ++elements;
+  }
+
+  void shrink_to_fit()
+  {
+    storage.shrink_to_fit();
+  }
+
   std::uint8_t operator[](size_t idx) const
   {
     return (storage[idx / elements_per_byte]  >> (bits * (idx % elements_per_byte))) & max_size;
@@ -1,12 +1,12 @@
 #pragma once
 
+#include "build_stats.hpp"
 #include "containers.hpp"
 #include "impl/get_matchings.hpp"
 #include "match.hpp"
 #include "sa_compute.hpp"
 
 #include <algorithm>
-#include <chrono>
 #include <istream>
 #include <iterator>
 #include <memory>
@@ -34,21 +34,18 @@ std::tuple<
 )
 {
   using Symbol = typename Alphabet::Symbol;
-  namespace chr = std::chrono;
-  // auto t_1 = chr::high_resolution_clock::now();
 
   /* Get joined string */
   auto Tsh = std::make_shared<std::vector<Symbol>>();
   auto &T  = *Tsh;
   size_t ref_len, input_len;
-  std::tie(input_len, ref_len) = impl::read_joined<Alphabet>(in_dump, ref_dump, T);
-
-  // auto t_2 = chr::high_resolution_clock::now();
-  // std::cerr << "--- Reading  = " 
-  //           << chr::duration_cast<chr::microseconds>(t_2 - t_1).count()
-  //           << " μs" << std::endl;
+  {
+    instrument::scoped_stage stage("join");
+    std::tie(input_len, ref_len) = impl::read_joined<Alphabet>(in_dump, ref_dump, T);
+    stage.add_bytes(T.size() * sizeof(Symbol));
+  }
 
-  /* Compute SA and LCP values */
+  /* Compute SA and LCP values (timed by sa_compute) */
   sdsl::int_vector<> SA, LCP;
 
 #if 0
@@ -62,12 +59,7 @@ std::tuple<
   std::cout << std::endl;
 #endif
 
-  // t_1 = chr::high_resolution_clock::now();
   rlz::sa_compute<Symbol>{}(T.data(), SA, LCP, T.size());
-  // t_2 = chr::high_resolution_clock::now();
-  // std::cerr << "--- SA       = " 
-  //           << chr::duration_cast<chr::microseconds>(t_2 - t_1).count()
-  //           << " μs" << std::endl;
 
 
 #if 0
@@ -103,12 +95,9 @@ std::tuple<
 
   T[input_len] = Symbol{};
 
-  // t_1 = chr::high_resolution_clock::now();
+  instrument::scoped_stage match_stage("longest_match", T.size() * sizeof(Symbol));
   auto M = impl::longest_match(SA.begin(), LCP.begin(), ref_len, input_len);
-  // t_2 = chr::high_resolution_clock::now();
-  // std::cerr << "--- Matching = " 
-  //           << chr::duration_cast<chr::microseconds>(t_2 - t_1).count()
-  //           << " μs" << std::endl;
+  match_stage.stop();
 
   mapped_stream<Alphabet> input_s(Tsh, 0U, input_len);
   mapped_stream<Alphabet> ref_s(Tsh, input_len + 1, ref_len);
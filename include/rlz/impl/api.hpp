@@ -1,16 +1,20 @@
 #pragma once
 
+#include <iterator>
 #include <memory>
 #include <sstream>
+#include <string>
 #include <type_traits>
 #include <stdexcept>
 #include <vector>
 
 #include "../build_coordinator.hpp"
+#include "../build_stats.hpp"
 #include "../containers.hpp"
 #include "../get_matchings.hpp"
 #include "../index.hpp"
 #include "../io.hpp"
+#include "../paged_container.hpp"
 #include "../parse.hpp"
 #include "../type_utils.hpp"
 
@@ -18,25 +22,51 @@ namespace rlz {
 
 namespace impl {
 
+// Input symbols covered by a match range (one match per input position), in bytes; 0 when the
+// range cannot be measured without consuming it.
+template <typename Alphabet, typename MatchIt>
+auto match_bytes(MatchIt b, MatchIt e)
+  -> typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<MatchIt>::iterator_category>::value, size_t>::type
+{
+  return std::distance(b, e) * sizeof(typename Alphabet::Symbol);
+}
+
+template <typename Alphabet, typename MatchIt>
+auto match_bytes(MatchIt, MatchIt)
+  -> typename std::enable_if<!std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<MatchIt>::iterator_category>::value, size_t>::type
+{
+  return 0UL;
+}
+
 template <typename Alphabet, typename ParseKeeper, typename LiteralKeeper, typename ParserType, typename Reference, typename SymbolIt, typename Match_It>
 index<Alphabet, Reference, ParseKeeper, LiteralKeeper> construct(
   SymbolIt input, Reference reference,
   ParserType parser,
-  Match_It m_begin, Match_It m_end
+  Match_It m_begin, Match_It m_end,
+  build::phrase_bounds bounds = build::phrase_bounds()
 )
 {
   using Index   = index<Alphabet, Reference, ParseKeeper, LiteralKeeper>;
   using Builder = typename Index::template builder<SymbolIt>;
   auto builder  = std::make_shared<Builder>();
   std::vector<std::shared_ptr<build::observer<Alphabet, SymbolIt>>> obs {{ builder }};
+  if (bounds.any()) {
+    obs.push_back(std::make_shared<build::phrase_limit<Alphabet, SymbolIt>>(bounds));
+  }
   build::coordinator<Alphabet, SymbolIt> coord(obs.begin(), obs.end(), input);
 
   auto copy_evt    = [&] (size_t position, size_t ptr, size_t len) { return coord.copy_evt(position, ptr,len); };
   auto literal_evt = [&] (size_t position, size_t length) { return coord.literal_evt(position,length); };
   auto end_evt     = [&] () { return coord.end_evt(); };
 
+  instrument::scoped_stage parse_stage("parse", match_bytes<Alphabet>(m_begin, m_end));
   parser(m_begin, m_end, reference.size(), literal_evt, copy_evt, end_evt);
-  return builder->get(std::move(reference));
+  parse_stage.stop();
+
+  instrument::scoped_stage encode_stage("encode");
+  auto idx = builder->get(std::move(reference));
+  encode_stage.add_bytes(idx.size() * sizeof(typename Alphabet::Symbol));
+  return idx;
 }
 
 template <typename Masked, typename Alphabet>
@@ -126,5 +156,20 @@ public:
   }
 };
 
+class paged_factory {
+  std::string reference;
+  size_t      ram_budget;
+  size_t      page_bytes;
+public:
+  paged_factory(std::string reference, size_t ram_budget, size_t page_bytes)
+    : reference(std::move(reference)), ram_budget(ram_budget), page_bytes(page_bytes) { }
+
+  template <typename Alphabet>
+  paged_reference<Alphabet> get() const
+  {
+    return paged_reference<Alphabet>(reference.c_str(), ram_budget, page_bytes);
+  }
+};
+
 }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 namespace rlz { namespace prefix { namespace impl { 
 
@@ -43,4 +45,51 @@ namespace mask_gen {
     using gen = generator<bits, element>;
   };
 } 
+
+namespace word_sum {
+
+  // Selects bit b of every bits-wide field in a 64-bit word
+  template <size_t bits>
+  constexpr std::uint64_t field_mask(size_t b)
+  {
+    return (0xFFFFFFFFFFFFFFFFULL / ((1ULL << bits) - 1)) << b;
+  }
+
+  template <size_t bits, size_t b>
+  struct fields {
+    static size_t sum(std::uint64_t w)
+    {
+      return (static_cast<size_t>(__builtin_popcountll(w & field_mask<bits>(b - 1))) << (b - 1)) +
+             fields<bits, b - 1>::sum(w);
+    }
+  };
+
+  template <size_t bits>
+  struct fields<bits, 0> {
+    static size_t sum(std::uint64_t) { return 0UL; }
+  };
+
+  inline std::uint64_t load(const std::uint8_t *ptr, size_t bytes = sizeof(std::uint64_t))
+  {
+    std::uint64_t w = 0ULL;
+    std::memcpy(&w, ptr, bytes);
+    return w;
+  }
+
+  // Sums the first n bits-wide fields packed (little-endian) from ptr, one 64-bit word at a time.
+  // The last partial word is copied byte-wise, so no byte past the last field is ever read.
+  template <size_t bits>
+  size_t sum(const std::uint8_t *ptr, size_t n)
+  {
+    constexpr size_t per_word = 64UL / bits;
+    size_t total = 0UL;
+    for (; n >= per_word; n -= per_word, ptr += sizeof(std::uint64_t)) {
+      total += fields<bits, bits>::sum(load(ptr));
+    }
+    if (n > 0) {
+      total += fields<bits, bits>::sum(load(ptr, (n * bits + 7) / 8) & ((1ULL << (n * bits)) - 1));
+    }
+    return total;
+  }
+}
 }}}
\ No newline at end of file
@@ -9,11 +9,14 @@
 #include <type_traits>
 #include <vector>
 
+#include <boost/iterator/iterator_facade.hpp>
+
 #include <sdsl/util.hpp>
 
 #include "integer_type.hpp"
 #include "parse_keeper.hpp"
 #include "literal_keeper.hpp"
+#include "reference_wrap.hpp"
 #include "type_name.hpp"
 #include "type_utils.hpp"
 
@@ -56,10 +59,11 @@ protected:
   LiteralKeeper                     literals;
   target_get<ParseKeeper::ptr_size> get_target;
 public:
-  using AlphabetType  = Alphabet;
-  using Symbol        = typename Alphabet::Symbol;
-  using ReferenceType = Source;
-  using size_type     = size_t;
+  using AlphabetType    = Alphabet;
+  using Symbol          = typename Alphabet::Symbol;
+  using ReferenceType   = Source;
+  using LiteralIterator = typename LiteralKeeper::iterator;
+  using size_type       = size_t;
   static_assert(
     type_utils::is_complaint<decltype(source[0]), Symbol>(),
     // std::is_same<type_utils::RemoveQualifiers<>, Symbol>::value, 
@@ -77,6 +81,19 @@ public:
   Symbol operator()(size_t idx) const;
   std::vector<Symbol> operator()(size_t begin, size_t end) const;
 
+  // Stateful access for streams of nearby queries
+  class cursor;
+  cursor get_cursor(size_t max_scan = 4096UL) const;
+
+  // Visits [begin, end) as spans of symbols (see cursor::segments)
+  template <typename Visitor>
+  void segments(size_t begin, size_t end, Visitor &&f) const;
+
+  // Forward iteration over the whole text
+  class const_iterator;
+  const_iterator begin() const;
+  const_iterator end() const;
+
   // Parse functions
   template <typename Func>
   void process_parsing(Func &f) const
@@ -94,11 +111,36 @@ public:
     }
   }
 
+  // As process_parsing, also passing an iterator to the literals of every subphrase and whether
+  // it starts a block
+  template <typename Func>
+  void process_subphrases(Func &f) const
+  {
+    auto parse_it  = parse.get_iterator_begin();
+    auto len_it    = literals.get_iterator(0UL);
+    auto lit_it    = literals.literal_access(0UL);
+    auto parse_end = parse.get_iterator_end();
+    for (auto subphrase = 0UL; parse_it != parse_end; ++subphrase) {
+      std::int64_t offset;
+      size_t phrase_start, phrase_len, lit_len;
+      std::tie(phrase_start, offset, phrase_len) = *parse_it++;
+      std::int64_t target = get_target(phrase_start, offset);
+      lit_len = *len_it++;
+      f(target - phrase_start, phrase_len, lit_len, lit_it, parse.starts_block(subphrase));
+      std::advance(lit_it, lit_len);
+    }
+  }
+
   size_t size() const
   {
     return parse.length();
   }
 
+  const Source &get_source() const
+  {
+    return source;
+  }
+
   template <typename SourceT>
   void set_source(SourceT &&s)
   {
@@ -121,6 +163,13 @@ public:
     parse.load(in);
     literals.load(in);
   }
+
+  // Parse and literals as independent sections (see serialize::format)
+  size_t serialize_parse(std::ostream& out) const { return parse.serialize(out, nullptr, "parse"); }
+  size_t serialize_literals(std::ostream& out) const { return literals.serialize(out, nullptr, "literals"); }
+  void load_parse(std::istream& in) { parse.load(in); }
+  void load_literals(std::istream& in) { literals.load(in); }
+
   template <typename SymbolIt>
   class builder : public rlz::build::observer<Alphabet, SymbolIt> {
     using Symbol        = typename Alphabet::Symbol;
@@ -175,6 +224,325 @@ public:
   };
 };
 
+namespace impl {
+
+// Contiguous memory behind a Source iterator, when there is one: raw pointers and wrappers
+// (const_wrap_iterator) of raw pointers to the same symbol type.
+template <typename It, typename Symbol>
+struct span_access {
+  static constexpr bool contiguous = false;
+};
+
+template <typename Symbol>
+struct span_access<const Symbol*, Symbol> {
+  static constexpr bool contiguous = true;
+  static const Symbol *get(const Symbol *p) { return p; }
+};
+
+template <typename Symbol>
+struct span_access<Symbol*, Symbol> {
+  static constexpr bool contiguous = true;
+  static const Symbol *get(Symbol *p) { return p; }
+};
+
+template <typename OrigIter, typename Symbol>
+struct span_access<const_wrap_iterator<OrigIter, Symbol>, Symbol> {
+  static constexpr bool contiguous = span_access<OrigIter, Symbol>::contiguous;
+  static const Symbol *get(const const_wrap_iterator<OrigIter, Symbol> &it)
+  {
+    return span_access<OrigIter, Symbol>::get(it.base());
+  }
+};
+
+}
+
+// Remembers the subphrase of the last accessed position, together with its parse, literal-length
+// and literal iterators. A forward seek closer than max_scan symbols walks the parse from there;
+// farther or backward seeks fall back to rank-based repositioning.
+template <typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper>
+class index<Alphabet, Source, ParseKeeper, LiteralKeeper>::cursor {
+  using Index   = index<Alphabet, Source, ParseKeeper, LiteralKeeper>;
+  using ParseIt = type_utils::RemoveQualifiers<decltype(std::declval<const ParseKeeper&>().get_iterator_begin())>;
+  using LenIt   = typename LiteralKeeper::lit_iter;
+  using LitIt   = typename LiteralKeeper::iterator;
+
+  friend class Index::const_iterator;
+
+  const Index   *idx;
+  size_t        max_scan;
+  bool          valid;
+  ParseIt       parse_it;   // Subphrase following the current one
+  LenIt         len_it;     // Literal length of the subphrase following the current one
+  LitIt         lit_it;     // First literal symbol of the current subphrase
+  size_t        start;      // Current subphrase: [start, start + copy_len + lit_len)
+  std::int64_t  ptr;
+  size_t        copy_len;
+  size_t        lit_len;
+
+  size_t end_pos() const { return start + copy_len + lit_len; }
+
+  void load_next()
+  {
+    std::tie(start, ptr, copy_len) = *parse_it++;
+    lit_len   = *len_it++;
+    copy_len -= lit_len;
+  }
+
+  void reposition(size_t pos)
+  {
+    size_t phrase, subphrase;
+    std::tie(phrase, subphrase) = idx->parse.phrase_subphrase(pos);
+    parse_it = idx->parse.get_iterator(phrase, subphrase);
+    len_it   = idx->literals.get_iterator(subphrase);
+    lit_it   = idx->literals.literal_access(subphrase);
+    load_next();
+    valid    = true;
+  }
+
+  void next_subphrase()
+  {
+    std::advance(lit_it, lit_len);
+    load_next();
+  }
+
+public:
+  cursor(const Index *idx, size_t max_scan)
+    : idx(idx), max_scan(max_scan), valid(false), parse_it(idx->parse.get_iterator_end()),
+      len_it(idx->literals.get_iterator_end()), lit_it(idx->literals.literal_access(0UL)),
+      start(0UL), ptr(0), copy_len(0UL), lit_len(0UL)
+  { }
+
+  // Moves to the subphrase holding pos (pos < size())
+  void seek(size_t pos)
+  {
+    if (valid and pos >= start) {
+      if (pos < end_pos()) {
+        return;
+      }
+      if (pos - end_pos() < max_scan) {
+        while (pos >= end_pos()) {
+          next_subphrase();
+        }
+        return;
+      }
+    }
+    reposition(pos);
+  }
+
+  Symbol operator()(size_t pos)
+  {
+    seek(pos);
+    auto offset = pos - start;
+    if (offset < copy_len) {
+      return idx->source[idx->get_target(pos, ptr)];
+    }
+    return *std::next(lit_it, offset - copy_len);
+  }
+
+  // Writes [begin, end) to out; the cursor is left on the subphrase holding end - 1.
+  template <typename OutputIt>
+  OutputIt operator()(size_t begin, size_t end, OutputIt out)
+  {
+    auto copy_part = [&] (size_t target, size_t len) {
+      auto target_beg = std::next(idx->source.begin(), target);
+      out = std::copy(target_beg, std::next(target_beg, len), out);
+    };
+    auto literal_part = [&] (LitIt lit, size_t len) {
+      out = std::copy(lit, std::next(lit, len), out);
+    };
+    walk(begin, end, copy_part, literal_part);
+    return out;
+  }
+
+  // Calls f(const Symbol *span, size_t length) on consecutive spans covering [begin, end).
+  // Copy parts point straight into the reference when it is stored contiguously in memory and
+  // stay valid as long as it does; literals, and copies from other sources, are decoded into a
+  // scratch buffer only valid during the call.
+  template <typename Visitor>
+  void segments(size_t begin, size_t end, Visitor &&f)
+  {
+    using Access = impl::span_access<type_utils::RemoveQualifiers<decltype(idx->source.begin())>, Symbol>;
+    const size_t chunk = std::max<size_t>(LiteralKeeper::max_literal_length, 4096UL);
+    std::vector<Symbol> scratch;
+    auto copy_part = [&] (size_t target, size_t len) {
+      emit_copy(target, len, f, scratch, chunk, std::integral_constant<bool, Access::contiguous>{});
+    };
+    auto literal_part = [&] (LitIt lit, size_t len) {
+      scratch.resize(std::max(scratch.size(), len));
+      std::copy(lit, std::next(lit, len), scratch.begin());
+      f(static_cast<const Symbol*>(scratch.data()), len);
+    };
+    walk(begin, end, copy_part, literal_part);
+  }
+
+private:
+  // Splits [begin, end) in copy parts, reported as copy_part(reference offset, length), and
+  // literal parts, reported as literal_part(first literal, length); no part is empty.
+  template <typename CopyFun, typename LitFun>
+  void walk(size_t begin, size_t end, CopyFun &copy_part, LitFun &literal_part)
+  {
+    if (begin >= end) {
+      return;
+    }
+    seek(begin);
+    auto current = begin;
+    while (true) {
+      auto offset = current - start;
+      if (offset < copy_len) {
+        auto len = std::min(copy_len - offset, end - current);
+        copy_part(idx->get_target(current, ptr), len);
+        current += len;
+        offset  += len;
+      }
+      if (current == end) {
+        break;
+      }
+      auto lit_off = offset - copy_len;
+      auto len     = std::min(lit_len - lit_off, end - current);
+      // Subphrases without literals report no literal part
+      if (len > 0) {
+        literal_part(std::next(lit_it, lit_off), len);
+        current += len;
+      }
+      if (current == end) {
+        break;
+      }
+      next_subphrase();
+    }
+  }
+
+  template <typename Visitor>
+  void emit_copy(size_t target, size_t len, Visitor &f, std::vector<Symbol> &, size_t, std::true_type)
+  {
+    using Access = impl::span_access<type_utils::RemoveQualifiers<decltype(idx->source.begin())>, Symbol>;
+    f(Access::get(std::next(idx->source.begin(), target)), len);
+  }
+
+  template <typename Visitor>
+  void emit_copy(size_t target, size_t len, Visitor &f, std::vector<Symbol> &scratch, size_t chunk, std::false_type)
+  {
+    scratch.resize(std::max(scratch.size(), std::min(chunk, len)));
+    auto it = std::next(idx->source.begin(), target);
+    while (len > 0) {
+      auto part = std::min(chunk, len);
+      auto next = std::next(it, part);
+      std::copy(it, next, scratch.begin());
+      f(static_cast<const Symbol*>(scratch.data()), part);
+      it   = next;
+      len -= part;
+    }
+  }
+};
+
+// Walks the parse, literal-length and literal iterators in lockstep: an increment moves a
+// reference or a literal iterator, and steps to the next subphrase at its end, so a full scan
+// costs one rank at construction and amortized constant time per symbol.
+template <typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper>
+class index<Alphabet, Source, ParseKeeper, LiteralKeeper>::const_iterator
+  : public boost::iterator_facade<
+        index<Alphabet, Source, ParseKeeper, LiteralKeeper>::const_iterator,
+        typename Alphabet::Symbol,
+        boost::forward_traversal_tag,
+        typename Alphabet::Symbol
+    >
+{
+  using Index = index<Alphabet, Source, ParseKeeper, LiteralKeeper>;
+  using SrcIt = type_utils::RemoveQualifiers<decltype(std::declval<const Source&>().begin())>;
+  using LitIt = typename LiteralKeeper::iterator;
+
+  cursor  cur;
+  size_t  pos;
+  size_t  len;
+  bool    in_copy;
+  SrcIt   src;    // Current symbol, inside a copy part
+  LitIt   lit;    // Current symbol, inside a literal part
+
+  void enter()
+  {
+    auto offset = pos - cur.start;
+    in_copy     = offset < cur.copy_len;
+    if (in_copy) {
+      src = std::next(cur.idx->source.begin(), cur.idx->get_target(pos, cur.ptr));
+    } else {
+      lit = std::next(cur.lit_it, offset - cur.copy_len);
+    }
+  }
+
+  friend class boost::iterator_core_access;
+
+  Symbol dereference() const
+  {
+    return in_copy ? *src : *lit;
+  }
+
+  bool equal(const const_iterator &other) const
+  {
+    return pos == other.pos;
+  }
+
+  void increment()
+  {
+    if (++pos == len) {
+      return;
+    }
+    auto offset = pos - cur.start;
+    if (offset < cur.copy_len) {
+      ++src;
+    } else if (offset < cur.copy_len + cur.lit_len) {
+      if (in_copy) {
+        in_copy = false;
+        lit     = cur.lit_it;
+      } else {
+        ++lit;
+      }
+    } else {
+      while (pos >= cur.end_pos()) {
+        cur.next_subphrase();
+      }
+      enter();
+    }
+  }
+
+public:
+  const_iterator(const Index *idx, size_t pos)
+    : cur(idx, 0UL), pos(pos), len(idx->size()), in_copy(false),
+      src(idx->source.begin()), lit(cur.lit_it)
+  {
+    if (pos < len) {
+      cur.seek(pos);
+      enter();
+    }
+  }
+};
+
+template <typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper>
+typename index<Alphabet, Source, ParseKeeper, LiteralKeeper>::const_iterator
+index<Alphabet, Source, ParseKeeper, LiteralKeeper>::begin() const
+{
+  return const_iterator(this, 0UL);
+}
+
+template <typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper>
+typename index<Alphabet, Source, ParseKeeper, LiteralKeeper>::const_iterator
+index<Alphabet, Source, ParseKeeper, LiteralKeeper>::end() const
+{
+  return const_iterator(this, size());
+}
+
+template <typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper>
+typename index<Alphabet, Source, ParseKeeper, LiteralKeeper>::cursor
+index<Alphabet, Source, ParseKeeper, LiteralKeeper>::get_cursor(size_t max_scan) const
+{
+  return cursor(this, max_scan);
+}
+
+template <typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper>
+template <typename Visitor>
+void index<Alphabet, Source, ParseKeeper, LiteralKeeper>::segments(size_t begin, size_t end, Visitor &&f) const
+{
+  get_cursor().segments(begin, end, std::forward<Visitor>(f));
+}
+
 template <typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper>
 template <typename OutputIt>
 void index<Alphabet, Source, ParseKeeper, LiteralKeeper>::operator()(size_t begin, size_t end, OutputIt output) const
@@ -249,17 +617,15 @@ void index<Alphabet, Source, ParseKeeper, LiteralKeeper>::operator()(size_t begi
 template <typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper>
 typename Alphabet::Symbol index<Alphabet, Source, ParseKeeper, LiteralKeeper>::operator()(size_t idx) const
 {
-  // Find phrase and subphrase
-  size_t phrase, subphrase;
-  std::tie(phrase, subphrase) = parse.phrase_subphrase(idx);
-
-  auto next_phrase = parse.start_subphrase(subphrase + 1);
+  // Subphrase and its end; the phrase rank is needed only for copied symbols
+  auto subphrase   = parse.subphrase(idx);
+  auto next_phrase = parse.next_subphrase_start(idx, subphrase);
   auto junk_length = literals.literal_length(subphrase);
   const auto junk_start  = next_phrase - junk_length;
   if (junk_start <= idx) {
     return *std::next(literals.literal_access(subphrase), idx - junk_start);
   } else {
-    auto ptr = parse.get_ptr(phrase, subphrase);
+    auto ptr = parse.get_ptr(parse.phrase(subphrase), subphrase);
     assert((ptr >= 0) or (-ptr < idx));
     return source[get_target(idx, ptr)];
   }
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "impl/api.hpp"
+#include "index.hpp"
+#include "index_merge.hpp"
+#include "reference_matcher.hpp"
+
+namespace rlz {
+
+// Start of the last subphrase of idx (0 when empty)
+template <typename Index>
+size_t last_subphrase(const Index &idx)
+{
+  auto start = 0UL, last = 0UL;
+  auto visit = [&] (std::int64_t, size_t phrase_len, size_t, typename Index::LiteralIterator, bool) {
+    last   = start;
+    start += phrase_len;
+  };
+  idx.process_subphrases(visit);
+  return last;
+}
+
+// Extends idx with the symbols in [begin, end), as if it had been built on the longer input.
+//
+// Only the tail is parsed: parsing restarts at the last subphrase of idx, so that its phrase may
+// grow into the new symbols, and the matching statistics of that tail come from matcher, built
+// once on the reference of idx. bounds, if any, should be those idx was built with; they apply
+// to positions in the whole input.
+//
+// The parse and literal structures, with their supports, are then rebuilt by a linear replay of
+// the kept subphrases followed by the new ones (see index_merger): every append costs time linear
+// in the size of the whole index, not only of the new symbols, and holds two copies of the index
+// in memory while it runs. Batch small appends together.
+template <
+  typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper,
+  typename ParserType, typename InputIt
+>
+void append(
+  index<Alphabet, Source, ParseKeeper, LiteralKeeper> &idx,
+  const reference_matcher<Alphabet> &matcher,
+  ParserType parser,
+  InputIt begin, InputIt end,
+  build::phrase_bounds bounds = build::phrase_bounds()
+)
+{
+  using Index = index<Alphabet, Source, ParseKeeper, LiteralKeeper>;
+  if (matcher.reference_size() != idx.get_source().size()) {
+    throw std::logic_error("append: matcher built on a different reference");
+  }
+  if (begin == end) {
+    return;
+  }
+  auto restart = last_subphrase(idx);
+  auto tail    = idx(restart, idx.size());
+  tail.insert(tail.end(), begin, end);
+
+  auto matches = matcher(idx.get_source().begin(), tail.data(), tail.size());
+  auto parsed  = impl::construct<Alphabet, ParseKeeper, LiteralKeeper>(
+    tail.data(), idx.get_source(), parser, matches.begin(), matches.end(), bounds.at(restart)
+  );
+
+  index_merger<Index> merger;
+  merger.append(idx, restart);
+  merger.append(parsed);
+  idx = merger.get();
+}
+
+}
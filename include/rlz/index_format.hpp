@@ -0,0 +1,454 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+namespace rlz { namespace serialize { namespace format {
+
+// Layout of a stored index (version 4), all integers in native byte order:
+//
+//   magic[8] | version (32) | configuration id (32) | #sections (32) | table CRC32C (32)
+//   reference length (64)
+//   #sections x { offset (64), length (64), CRC32C (32), reserved (32) }
+//   section payloads
+//
+// Offsets are relative to the start of the header. The reference length, in symbols, is checked
+// against the reference an index is loaded or merged with. Sections are, in order, the parse and the
+// literals of the index, each one an sdsl-style serialization. Files without the magic number
+// (written before the header existed) or with another version are rejected: their sections may
+// have a different layout, so they must be rebuilt.
+//
+// Sections are never held in memory as a whole: checksums are computed while they stream to and
+// from the file, and loading from a file reads every section through its own stream, at its
+// offset, so that they load concurrently.
+//
+// The version also covers the serialization of the sections, and changes with it:
+//   1: bitset skip tables and lcp exception markers always stored
+//   2: bitset skip tables rebuilt on load; lcp exception markers stored only if there are exceptions
+//   3: reference length in the header
+//   4: bitset skip tables stored again, after the bitsets they index
+
+constexpr const char   magic[8]      = { 'R', 'L', 'Z', 'A', 'P', 'I', 'D', 'X' };
+constexpr std::uint32_t version      = 4U;
+constexpr std::uint32_t no_sections  = 2U;
+
+namespace detail {
+
+inline const std::array<std::uint32_t, 256> &crc_table()
+{
+  static const std::array<std::uint32_t, 256> table = [] {
+    std::array<std::uint32_t, 256> t;
+    for (std::uint32_t i = 0U; i < 256U; ++i) {
+      std::uint32_t c = i;
+      for (auto k = 0U; k < 8U; ++k) {
+        c = (c & 1U) ? (c >> 1) ^ 0x82F63B78U : (c >> 1);
+      }
+      t[i] = c;
+    }
+    return t;
+  }();
+  return table;
+}
+
+}
+
+// CRC32C (Castagnoli), hardware-accelerated when SSE4.2 is available.
+inline std::uint32_t crc32c(const char *data, size_t len, std::uint32_t crc = 0U)
+{
+  crc = ~crc;
+#ifdef __SSE4_2__
+  std::uint64_t c = crc;
+  for (; len >= 8U; len -= 8U, data += 8U) {
+    std::uint64_t w;
+    std::memcpy(&w, data, sizeof(w));
+    c = _mm_crc32_u64(c, w);
+  }
+  crc = static_cast<std::uint32_t>(c);
+  for (; len > 0U; --len, ++data) {
+    crc = _mm_crc32_u8(crc, static_cast<std::uint8_t>(*data));
+  }
+#else
+  const auto &table = detail::crc_table();
+  for (; len > 0U; --len, ++data) {
+    crc = table[(crc ^ static_cast<std::uint8_t>(*data)) & 0xFFU] ^ (crc >> 8);
+  }
+#endif
+  return ~crc;
+}
+
+inline std::uint32_t crc32c(const std::string &s)
+{
+  return crc32c(s.data(), s.size());
+}
+
+// Output buffer forwarding to dest (or discarding, if null), with the CRC32C and the length of
+// what went through it.
+class crc_writer : public std::streambuf {
+private:
+  std::streambuf    *dest;
+  std::vector<char> buf;
+  std::uint32_t     crc_;
+  std::uint64_t     bytes_;
+
+  bool flush_buffer()
+  {
+    auto n = pptr() - pbase();
+    if (n > 0) {
+      crc_    = crc32c(pbase(), n, crc_);
+      bytes_ += n;
+      if (dest != nullptr and dest->sputn(pbase(), n) != n) {
+        return false;
+      }
+    }
+    setp(buf.data(), buf.data() + buf.size());
+    return true;
+  }
+
+protected:
+  int_type overflow(int_type ch) override
+  {
+    if (!flush_buffer()) {
+      return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(ch);
+      pbump(1);
+    }
+    return traits_type::not_eof(ch);
+  }
+
+  int sync() override
+  {
+    return flush_buffer() ? 0 : -1;
+  }
+
+public:
+  explicit crc_writer(std::streambuf *dest, size_t buffer_bytes = 1UL << 16)
+    : dest(dest), buf(buffer_bytes), crc_(0U), bytes_(0UL)
+  {
+    setp(buf.data(), buf.data() + buf.size());
+  }
+
+  // Both valid after a flush
+  std::uint32_t crc() const { return crc_; }
+  std::uint64_t bytes() const { return bytes_; }
+};
+
+// Input buffer over the next length bytes of src, with the CRC32C of what was read from it.
+class section_reader : public std::streambuf {
+private:
+  std::streambuf    *src;
+  std::uint64_t     left;
+  std::vector<char> buf;
+  std::uint32_t     crc_;
+  std::uint64_t     bytes_;
+
+protected:
+  int_type underflow() override
+  {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+    if (left == 0UL) {
+      return traits_type::eof();
+    }
+    auto got = src->sgetn(buf.data(), std::min<std::uint64_t>(left, buf.size()));
+    if (got <= 0) {
+      return traits_type::eof();
+    }
+    crc_    = crc32c(buf.data(), got, crc_);
+    left   -= got;
+    bytes_ += got;
+    setg(buf.data(), buf.data(), buf.data() + got);
+    return traits_type::to_int_type(*gptr());
+  }
+
+public:
+  section_reader(std::streambuf *src, std::uint64_t length, size_t buffer_bytes = 1UL << 16)
+    : src(src), left(length), buf(std::min<std::uint64_t>(std::max<std::uint64_t>(length, 1UL), buffer_bytes)),
+      crc_(0U), bytes_(0UL)
+  {
+    setg(buf.data(), buf.data(), buf.data());
+  }
+
+  // Reads what is left of the section, so that crc() covers all of it
+  void drain()
+  {
+    do {
+      setg(buf.data(), buf.data(), buf.data());
+    } while (!traits_type::eq_int_type(underflow(), traits_type::eof()));
+  }
+
+  std::uint32_t crc() const { return crc_; }
+  std::uint64_t bytes() const { return bytes_; }
+};
+
+struct section {
+  std::uint64_t offset;
+  std::uint64_t length;
+  std::uint32_t crc;
+  std::uint32_t reserved;
+};
+
+struct header {
+  std::uint32_t        version;
+  std::uint32_t        id;
+  std::uint64_t        reference_len;   // Symbols
+  std::vector<section> sections;
+
+  static constexpr size_t fixed_bytes = sizeof(magic) + 4U * sizeof(std::uint32_t) + sizeof(std::uint64_t);
+
+  size_t bytes() const
+  {
+    return fixed_bytes + sections.size() * sizeof(section);
+  }
+
+  std::uint32_t table_crc() const
+  {
+    return crc32c(reinterpret_cast<const char*>(sections.data()), sections.size() * sizeof(section));
+  }
+
+  void save(std::ostream &out) const
+  {
+    auto n   = static_cast<std::uint32_t>(sections.size());
+    auto crc = table_crc();
+    out.write(magic, sizeof(magic));
+    out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    out.write(reinterpret_cast<const char*>(&crc), sizeof(crc));
+    out.write(reinterpret_cast<const char*>(&reference_len), sizeof(reference_len));
+    out.write(reinterpret_cast<const char*>(sections.data()), n * sizeof(section));
+  }
+
+  // Reads the fields following the magic number.
+  static header load(std::istream &in)
+  {
+    header h;
+    std::uint32_t n, crc;
+    in.read(reinterpret_cast<char*>(&h.version), sizeof(h.version));
+    in.read(reinterpret_cast<char*>(&h.id), sizeof(h.id));
+    in.read(reinterpret_cast<char*>(&n), sizeof(n));
+    in.read(reinterpret_cast<char*>(&crc), sizeof(crc));
+    in.read(reinterpret_cast<char*>(&h.reference_len), sizeof(h.reference_len));
+    if (!in) {
+      throw std::logic_error("Truncated index header");
+    }
+    if (h.version != format::version) {
+      throw std::logic_error(
+        "Index format version " + std::to_string(h.version) + " is not supported (expected " +
+        std::to_string(format::version) + "): rebuild the index"
+      );
+    }
+    if (n != no_sections) {
+      throw std::logic_error("Corrupted index header: unexpected number of sections");
+    }
+    h.sections.resize(n);
+    in.read(reinterpret_cast<char*>(h.sections.data()), n * sizeof(section));
+    if (!in or h.table_crc() != crc) {
+      throw std::logic_error("Corrupted index header: section table checksum mismatch");
+    }
+    return h;
+  }
+};
+
+// Checks that the index was built against a reference of reference_len symbols.
+inline void check_reference(const header &h, std::uint64_t reference_len)
+{
+  if (h.reference_len != reference_len) {
+    throw std::logic_error(
+      "Index built against a reference of " + std::to_string(h.reference_len) + " symbols, not " +
+      std::to_string(reference_len) + ": wrong reference"
+    );
+  }
+}
+
+// Consumes the magic number, which every supported index starts with.
+inline void read_magic(std::istream &in)
+{
+  char buf[sizeof(magic)];
+  in.read(buf, sizeof(buf));
+  if (!in or std::memcmp(buf, magic, sizeof(magic)) != 0) {
+    throw std::logic_error("Not an index, or an index written before format versioning: rebuild the index");
+  }
+}
+
+// Writes header and sections of idx (parse, literals), computing checksums on the fly. On a
+// seekable stream the header is written last, over a placeholder; otherwise every section is
+// serialized twice, first only to measure it.
+template <typename Index>
+header write(std::ostream &out, std::uint32_t id, const Index &idx)
+{
+  auto serialize_section = [&idx] (size_t i, std::ostream &o) {
+    if (i == 0UL) {
+      idx.serialize_parse(o);
+    } else {
+      idx.serialize_literals(o);
+    }
+  };
+  auto start    = out.tellp();
+  bool seekable = start != std::ostream::pos_type(-1);
+  header h { version, id, idx.get_source().size(), std::vector<section>(no_sections, section { 0UL, 0UL, 0U, 0U }) };
+  std::uint64_t offset = h.bytes();
+  if (!seekable) {
+    for (auto i = 0UL; i < h.sections.size(); ++i) {
+      crc_writer measure(nullptr);
+      std::ostream o(&measure);
+      serialize_section(i, o);
+      o.flush();
+      h.sections[i] = section { offset, measure.bytes(), measure.crc(), 0U };
+      offset += measure.bytes();
+    }
+    offset = h.bytes();
+  }
+  h.save(out);
+  for (auto i = 0UL; i < h.sections.size(); ++i) {
+    crc_writer writer(out.rdbuf());
+    std::ostream o(&writer);
+    serialize_section(i, o);
+    o.flush();
+    if (!o) {
+      throw std::logic_error("Index could not be written");
+    }
+    section written { offset, writer.bytes(), writer.crc(), 0U };
+    if (!seekable and (written.length != h.sections[i].length or written.crc != h.sections[i].crc)) {
+      throw std::logic_error("Index section " + std::to_string(i) + " serialized differently on two passes");
+    }
+    h.sections[i] = written;
+    offset       += written.length;
+  }
+  if (seekable) {
+    auto end = out.tellp();
+    out.seekp(start);
+    h.save(out);
+    out.seekp(end);
+  }
+  if (!out) {
+    throw std::logic_error("Index could not be written");
+  }
+  return h;
+}
+
+// Checks that the sections follow the header back to back, as written by write().
+inline void check_layout(const header &h)
+{
+  std::uint64_t expected = h.bytes();
+  for (const auto &s : h.sections) {
+    if (s.offset != expected) {
+      throw std::logic_error("Corrupted index header: sections are not contiguous");
+    }
+    expected += s.length;
+  }
+}
+
+// Reads section i from src with load (which may be empty, to only verify it). The whole section is
+// read even if load stops early, so that the checksum covers it; a checksum mismatch is reported
+// in place of any error raised by load.
+template <typename Load>
+void read_section(std::streambuf *src, const header &h, size_t i, Load &&load)
+{
+  section_reader reader(src, h.sections[i].length);
+  std::istream in(&reader);
+  auto check = [&] {
+    reader.drain();
+    if (reader.bytes() != h.sections[i].length) {
+      throw std::logic_error("Truncated index: section " + std::to_string(i) + " shorter than declared");
+    }
+    if (reader.crc() != h.sections[i].crc) {
+      throw std::logic_error("Corrupted index: checksum mismatch in section " + std::to_string(i));
+    }
+  };
+  try {
+    load(in);
+  } catch (...) {
+    check();
+    throw;
+  }
+  check();
+}
+
+// Verifies the checksum of every section, without loading the index.
+inline header verify(std::istream &in)
+{
+  read_magic(in);
+  auto h = header::load(in);
+  check_layout(h);
+  for (auto i = 0UL; i < h.sections.size(); ++i) {
+    read_section(in.rdbuf(), h, i, [] (std::istream &) { });
+  }
+  return h;
+}
+
+namespace detail {
+
+template <typename Index>
+void load_section(Index &idx, size_t i, std::istream &in)
+{
+  if (i == 0UL) {
+    idx.load_parse(in);
+  } else {
+    idx.load_literals(in);
+  }
+}
+
+}
+
+// Verifies and loads the sections following the header, one after the other, from in.
+template <typename Index>
+void load_sections(Index &idx, const header &h, std::istream &in)
+{
+  check_layout(h);
+  for (auto i = 0UL; i < h.sections.size(); ++i) {
+    read_section(in.rdbuf(), h, i, [&] (std::istream &s) { detail::load_section(idx, i, s); });
+  }
+}
+
+// Verifies and loads the parse and the literal sections concurrently, each one read from its own
+// stream over file_name at its offset. The header starts at base in the file.
+template <typename Index>
+void load_sections(Index &idx, const header &h, const char *file_name, std::uint64_t base = 0UL)
+{
+  check_layout(h);
+  auto load = [&] (size_t i) {
+    std::ifstream file(file_name, std::ios_base::in | std::ios_base::binary);
+    file.seekg(base + h.sections[i].offset);
+    if (!file) {
+      throw std::logic_error("Truncated index: section " + std::to_string(i) + " not found");
+    }
+    read_section(file.rdbuf(), h, i, [&] (std::istream &s) { detail::load_section(idx, i, s); });
+  };
+  std::exception_ptr parse_error;
+  std::thread parse_thread([&] {
+    try {
+      load(0UL);
+    } catch (...) {
+      parse_error = std::current_exception();
+    }
+  });
+  try {
+    load(1UL);
+  } catch (...) {
+    parse_thread.join();
+    throw;
+  }
+  parse_thread.join();
+  if (parse_error) {
+    std::rethrow_exception(parse_error);
+  }
+}
+
+} } }
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "index.hpp"
+
+namespace rlz {
+
+// Concatenates indexes of consecutive input segments, each built against the same reference and
+// with the same configuration. The subphrases of every part are replayed, shifted by the length of
+// the parts before it, into the builders of the merged index: pointers keep their reference
+// targets, with offsets rebased on the shifted positions, literals and their lengths are copied,
+// and the bit-vectors with their rank/select supports are rebuilt once, in a single pass and
+// without parsing the input again. Every block of a part stays a block, so that blocks forced at
+// build time (phrase_bounds::block_len) are kept, and every part starts a block; other subphrases
+// may start new blocks, as their rebased pointers require.
+template <typename Index>
+class index_merger {
+private:
+  using LitIt   = typename Index::LiteralIterator;
+  using Source  = typename Index::ReferenceType;
+  using Builder = typename Index::template builder<LitIt>;
+
+  std::unique_ptr<Builder> build;
+  Source                   source;
+  bool                     sourced;
+  size_t                   length;
+
+  void check() const
+  {
+    if (!build) {
+      throw std::logic_error("index_merger: merged index already retrieved");
+    }
+  }
+
+public:
+  // The reference is taken from the first part appended
+  index_merger() : build(new Builder()), sourced(false), length(0UL) { }
+
+  explicit index_merger(Source source) : build(new Builder()), source(std::move(source)), sourced(true), length(0UL) { }
+
+  // Appends the segment indexed by part
+  void append(const Index &part)
+  {
+    append(part, part.size());
+  }
+
+  // Appends the first prefix_len symbols of part, which must end on a subphrase boundary
+  void append(const Index &part, size_t prefix_len)
+  {
+    check();
+    if (!sourced) {
+      source  = part.get_source();
+      sourced = true;
+    }
+    // Offsets are relative to positions in part, which start at base in the merged text
+    const auto base = static_cast<std::int64_t>(length);
+    auto start      = 0UL;
+    auto replay     = [&] (std::int64_t offset, size_t phrase_len, size_t lit_len, LitIt lit, bool block) {
+      if (start >= prefix_len) {
+        return;
+      }
+      if (start + phrase_len > prefix_len) {
+        throw std::logic_error("index_merger: prefix does not end on a subphrase boundary");
+      }
+      append_subphrase(offset - base, phrase_len, lit_len, lit, block);
+      start += phrase_len;
+    };
+    part.process_subphrases(replay);
+    if (start != prefix_len) {
+      throw std::logic_error("index_merger: prefix longer than the index");
+    }
+  }
+
+  // Appends a single subphrase: a copy of phrase_len - lit_len symbols from reference position
+  // size() + offset, followed by the lit_len literals at lit. If block, the subphrase starts a
+  // block whatever its delta.
+  void append_subphrase(std::int64_t offset, size_t phrase_len, size_t lit_len, LitIt lit, bool block = false)
+  {
+    check();
+    auto copy_len = phrase_len - lit_len;
+    auto rebased  = static_cast<std::int64_t>(length) + offset;
+    if (copy_len > 0 and sourced and (rebased < 0 or static_cast<size_t>(rebased) + copy_len > source.size())) {
+      throw std::logic_error("index_merger: copy out of the reference (was the part built against another one?)");
+    }
+    // Empty copies carry no pointer: as the coordinator does for bare literals, use delta 0
+    auto target   = copy_len > 0 ? static_cast<size_t>(rebased) : length;
+    auto is_block = build->split_as_block(length, target, copy_len, lit_len, lit) or block;
+    build->split(length, target, copy_len, lit_len, lit, is_block);
+    length += phrase_len;
+  }
+
+  // Length of the text indexed so far
+  size_t size() const
+  {
+    return length;
+  }
+
+  Index get()
+  {
+    if (!sourced) {
+      throw std::logic_error("index_merger: no index to merge");
+    }
+    check();
+    build->finish();
+    auto to_ret = build->get(source);
+    build.reset();
+    return to_ret;
+  }
+};
+
+// Merges the indexes in [begin, end), in order.
+template <typename IndexIt>
+auto merge(IndexIt begin, IndexIt end) -> typename std::iterator_traits<IndexIt>::value_type
+{
+  index_merger<typename std::iterator_traits<IndexIt>::value_type> merger;
+  for (; begin != end; ++begin) {
+    merger.append(*begin);
+  }
+  return merger.get();
+}
+
+}
@@ -162,5 +162,43 @@ public:
   }
 
 };
+
+// Append-only adapter over an (unsigned) sdsl-like vector. Storage grows by LoadFactor
+// and is trimmed to the exact size by get(), so builders can fill packed vectors directly.
+template <typename Vector, typename LoadFactor = values::Rational<15, 10>, size_t MinimumLoad = 128U>
+class growable {
+private:
+  Vector data;
+  size_t size_;
+public:
+  growable() : size_(0U) { }
+
+  void push_back(const std::uint64_t &value)
+  {
+    if (size_ >= data.size()) {
+      data.resize(std::max<size_t>(data.size() * LoadFactor::value(), MinimumLoad));
+    }
+    data[size_++] = value;
+  }
+
+  std::uint64_t operator[](const size_t &idx) const
+  {
+    assert(idx < size());
+    return data[idx];
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0U; }
+
+  // Returns the vector trimmed to its size. The growable is left empty.
+  Vector get()
+  {
+    data.resize(size_);
+    Vector to_ret;
+    std::swap(to_ret, data);
+    size_ = 0U;
+    return to_ret;
+  }
+};
 }
 }
\ No newline at end of file
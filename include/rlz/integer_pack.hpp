@@ -5,6 +5,7 @@
 
 #include "sdsl_extensions/int_vector.hpp"
 
+#include "int_vector.hpp"
 #include "reference_wrap.hpp"
 #include "impl/alphabet.hpp"
 #include "type_name.hpp"
@@ -29,6 +30,25 @@ public:
     std::copy(begin, end, data.begin());
   }
 
+  class builder {
+    ds::growable<sdsl::extensions::int_vector<bits>> data;
+  public:
+    template <typename JunkIt>
+    void append(JunkIt begin, JunkIt end)
+    {
+      for (auto it = begin; it != end; ++it) {
+        data.push_back(*it);
+      }
+    }
+
+    integer_pack get()
+    {
+      integer_pack to_ret;
+      to_ret.data = data.get();
+      return to_ret;
+    }
+  };
+
   iterator from(std::size_t idx) const { return std::next(begin(), idx); }
 
   iterator begin() const { return iterator(data.begin()); }
@@ -68,9 +68,26 @@ public:
     }
   }
 
+  // Decodes one symbol in place: literals are read directly, copied symbols are rebuilt from
+  // the last literal and the reference differences, as in iter::dereference.
   Symbol operator()(size_t idx) const
   {
-    return (*this)(idx, idx + 1).front();
+    auto subphrase = parse.subphrase(idx);
+    auto start     = parse.start_subphrase(subphrase);
+    auto lit_len   = literals.literal_length(subphrase);
+    auto lits      = literals.literal_access(subphrase);
+    if (idx - start < lit_len) {
+      return *std::next(lits, idx - start);
+    }
+    auto ptr    = parse.get_ptr(parse.phrase(subphrase), subphrase);
+    auto target = get_target(start + lit_len, ptr);
+    Symbol ref  = source[target + (idx - start - lit_len)];
+    if (lit_len == 0) {
+      return ref;
+    }
+    Symbol last_lit = *std::next(lits, lit_len - 1);
+    Symbol prev_ref = target == 0 ? Symbol{} : source[target - 1];
+    return last_lit + ref - prev_ref;
   }
 
   std::vector<Symbol> operator()(size_t begin, size_t end) const
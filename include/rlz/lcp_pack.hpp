@@ -30,6 +30,25 @@ public:
       assert(std::equal(junk_begin, junk_end, junks.begin()));
   }
 
+  class builder {
+    typename sdsl::extensions::signed_lcp_byte<Symbol>::builder junks;
+  public:
+    template <typename JunkIt>
+    void append(JunkIt begin, JunkIt end)
+    {
+      for (auto it = begin; it != end; ++it) {
+        junks.push_back(*it);
+      }
+    }
+
+    lcp_pack get()
+    {
+      lcp_pack to_ret;
+      to_ret.junks = junks.get();
+      return to_ret;
+    }
+  };
+
   iterator from(size_t idx) const
   {
     return std::next(junks.begin(), idx);
@@ -79,11 +79,11 @@ public:
     using Symbol = typename Alphabet::Symbol;
     using lsk_t  = literal_split_keeper<Alphabet, Prefix>;
     enum State { FILLING, FILLED, FINISHED };
-    // WARNING: not very size-efficient, to be changed.
+    // Literals are appended straight into the packed representations.
     State state;
     size_t literal_length;
-    std::vector<size_t> lit_lengths;
-    std::vector<Symbol> literals;
+    typename Prefix::builder lit_lengths;
+    typename Packer::builder literals;
 
   public:
 
@@ -116,7 +116,7 @@ public:
       assert(state == FILLING);
       literal_length += junk_len;
       lit_lengths.push_back(junk_len);
-      literals.insert(literals.end(), bytes, std::next(bytes, junk_len));
+      literals.append(bytes, std::next(bytes, junk_len));
     }
 
     // Parsing finished
@@ -130,13 +130,8 @@ public:
     {
       assert(state == FILLED);
       lsk_t to_ret;
-
-      // Manage cumulative and lit_lengths
-      to_ret.lit_prefix   = Prefix(lit_lengths.begin(), lit_lengths.end());
-
-      // Manage junks
-      using Packer = typename Alphabet::Packer;
-      to_ret.pack         = Packer(literals.begin(), literals.end());
+      to_ret.lit_prefix   = lit_lengths.get();
+      to_ret.pack         = literals.get();
 
       state = FINISHED;
       return to_ret;
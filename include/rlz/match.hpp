@@ -14,7 +14,7 @@ struct match {
   match() : match(std::numeric_limits<size_t>::max(), 0U)
   { }
 
-  bool matched() { return len > 0U; }
+  bool matched() const { return len > 0U; }
 
   void store(std::ostream &os) const
   {
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include "sharded_lru.hpp"
+
+namespace rlz {
+
+namespace paging {
+
+// A read-only file accessed in fixed-size pages, fetched with pread into a bounded page cache.
+class page_file {
+public:
+  using page     = std::vector<char>;
+  using page_ptr = std::shared_ptr<const page>;
+
+private:
+  int                                  fd;
+  size_t                               bytes;
+  size_t                               page_bytes;
+  cache::sharded_lru<size_t, page>     pages;
+
+  page read_page(size_t no) const
+  {
+    auto offset = no * page_bytes;
+    page p(std::min(page_bytes, bytes - offset));
+    size_t done = 0UL;
+    while (done < p.size()) {
+      auto got = ::pread(fd, p.data() + done, p.size() - done, offset + done);
+      if (got < 0 and errno == EINTR) {
+        continue;
+      }
+      if (got <= 0) {
+        throw std::runtime_error("Failed to read page " + std::to_string(no) + ": " + std::strerror(errno));
+      }
+      done += got;
+    }
+    return p;
+  }
+
+  // Pages that fit in ram_budget; the cache keeps at least one page per shard, so there are
+  // never more shards than pages.
+  static size_t budget_pages(size_t ram_budget, size_t page_bytes)
+  {
+    if (ram_budget < page_bytes) {
+      throw std::logic_error("RAM budget smaller than one page");
+    }
+    return ram_budget / page_bytes;
+  }
+
+public:
+  // Keeps at most ram_budget bytes of pages in memory; ram_budget must hold at least one page.
+  page_file(const char *file_name, size_t page_bytes, size_t ram_budget, size_t shards = 16UL)
+    : fd(-1), bytes(0UL), page_bytes(page_bytes),
+      pages(budget_pages(ram_budget, page_bytes), std::min(shards, budget_pages(ram_budget, page_bytes)))
+  {
+    fd = ::open(file_name, O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error(std::string("Failed to open ") + file_name + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error(std::string("Failed to stat ") + file_name);
+    }
+    bytes = st.st_size;
+  }
+
+  page_file(const page_file&) = delete;
+  page_file &operator=(const page_file&) = delete;
+
+  ~page_file() { ::close(fd); }
+
+  size_t size() const { return bytes; }
+  size_t page_size() const { return page_bytes; }
+  // Upper bound on the bytes of pages held in memory
+  size_t cache_bytes() const { return pages.capacity() * page_bytes; }
+
+  page_ptr get(size_t no)
+  {
+    if (no >= (bytes + page_bytes - 1UL) / page_bytes) {
+      throw std::out_of_range("Page " + std::to_string(no) + " past the end of the file");
+    }
+    return pages.get(no, [&] { return read_page(no); });
+  }
+
+  // hits: pages served from memory; misses: page faults, each one a pread of page_size() bytes
+  cache::lru_stats stats() const { return pages.stats(); }
+  void reset_stats() { pages.reset_stats(); }
+};
+
+template <typename Symbol>
+class paged_iterator
+  : public boost::iterator_facade<paged_iterator<Symbol>, Symbol, boost::random_access_traversal_tag, Symbol>
+{
+  page_file                         *file;
+  std::ptrdiff_t                    pos;
+  // Page holding pos, fetched lazily; a sequential scan hits the cache once per page
+  mutable page_file::page_ptr       cur;
+  mutable std::ptrdiff_t            cur_no;
+
+  friend class boost::iterator_core_access;
+
+  Symbol dereference() const
+  {
+    const std::ptrdiff_t per_page = file->page_size() / sizeof(Symbol);
+    auto no = pos / per_page;
+    if (no != cur_no) {
+      cur    = file->get(no);
+      cur_no = no;
+    }
+    Symbol s;
+    std::memcpy(&s, cur->data() + (pos % per_page) * sizeof(Symbol), sizeof(Symbol));
+    return s;
+  }
+
+  bool equal(const paged_iterator &other) const { return pos == other.pos; }
+  void increment() { ++pos; }
+  void decrement() { --pos; }
+  void advance(std::ptrdiff_t n) { pos += n; }
+  std::ptrdiff_t distance_to(const paged_iterator &other) const { return other.pos - pos; }
+
+public:
+  paged_iterator() : file(nullptr), pos(0), cur_no(-1) { }
+  paged_iterator(page_file *file, std::ptrdiff_t pos) : file(file), pos(pos), cur_no(-1) { }
+};
+
+}
+
+// Reference (index Source) kept on disk: symbols are read through a page cache of bounded size.
+//
+// Only the reference is paged. The parse and literal keepers of an index stay in memory: they
+// are compressed, so they take a small fraction of the space of the reference, and every
+// extraction walks them (rank/select on the phrase bit-vectors, pointer and literal-length
+// lookups) before touching a single reference symbol, so paging them would add a page fault
+// to every access. Paging their payloads (pointers, diffs, literal lengths, literals) would also
+// take a storage parameter on every keeper and packer, hence new configuration ids and a new
+// format, for little resident memory saved.
+//
+// When many indexes share one reference, load them against the same paged_reference
+// (load_reference): the reference is then cached once, within one budget, and the resident
+// memory is that budget plus the sum of the compressed index sizes.
+template <typename Alphabet>
+class paged_reference {
+public:
+  using Symbol   = typename Alphabet::Symbol;
+  using Iterator = paging::paged_iterator<Symbol>;
+
+private:
+  std::shared_ptr<paging::page_file> file;
+
+public:
+  paged_reference() { }
+
+  paged_reference(const char *file_name, size_t ram_budget, size_t page_bytes = 1UL << 16)
+  {
+    if (page_bytes == 0UL or page_bytes % sizeof(Symbol) != 0UL) {
+      throw std::logic_error("Page size must be a positive multiple of the symbol size");
+    }
+    file = std::make_shared<paging::page_file>(file_name, page_bytes, ram_budget);
+  }
+
+  Iterator begin() const { return Iterator(file.get(), 0); }
+  Iterator end() const   { return Iterator(file.get(), size()); }
+
+  Symbol operator[](size_t pos) const { return *Iterator(file.get(), pos); }
+  size_t size() const { return file ? file->size() / sizeof(Symbol) : 0UL; }
+
+  size_t cache_bytes() const { return file->cache_bytes(); }
+
+  cache::lru_stats stats() const { return file->stats(); }
+  void reset_stats() const { file->reset_stats(); }
+};
+
+}
@@ -1,11 +1,11 @@
 #pragma once
 
+#include "build_stats.hpp"
 #include "dumper.hpp"
 #include "io.hpp"
 #include "get_matchings.hpp"
 
 #include <cassert>
-#include <chrono>
 #include <cstdlib>
 #include <functional>
 #include <iostream>
@@ -114,15 +114,12 @@ std::tuple<mapped_stream<Alphabet>, mapped_stream<Alphabet>> parse(
     std::tie(M, reference, input) = get_relative_matches<Alphabet>(ref_dump, input_dump);
   }
 
-  namespace chr = std::chrono;
-  auto t_1 = chr::high_resolution_clock::now();
-  Parser{edit_distance, phrase_threshold}(
-    M.begin(), M.end(), reference.size(), lit_evt, copy_evt, end_evt
-  );
-  auto t_2 = chr::high_resolution_clock::now();
-  std::cerr << "--- Parsing  = " 
-            << chr::duration_cast<chr::microseconds>(t_2 - t_1).count()
-            << " μs" << std::endl;
+  {
+    instrument::scoped_stage stage("parse", M.size() * sizeof(typename Alphabet::Symbol));
+    Parser{edit_distance, phrase_threshold}(
+      M.begin(), M.end(), reference.size(), lit_evt, copy_evt, end_evt
+    );
+  }
   return std::make_tuple(reference, input);
 }
 
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <limits>
+#include <type_traits>
 #include <vector>
 
 #include "bit_vectors.hpp"
@@ -18,6 +20,7 @@
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
+#include <sdsl/bits.hpp>
 #include <sdsl/int_vector.hpp>
 #include <sdsl/util.hpp>
 
@@ -41,6 +44,17 @@ private:
   ds::int_vector<PtrSize::value()>    ptrs;
   ds::int_vector<DiffSize::value()>   diffs;
 
+  size_t next_start(size_t, size_t subphrase, std::true_type) const
+  {
+    return start_subphrase(subphrase + 1);
+  }
+
+  size_t next_start(size_t position, size_t subphrase, std::false_type) const
+  {
+    auto word = sbv.get_int(position, std::min<size_t>(64UL, sbv.size() - position));
+    return word != 0 ? position + sdsl::bits::lo(word) + 1UL : start_subphrase(subphrase + 1);
+  }
+
 public:
 
   using ptr_type = std::int64_t;
@@ -84,6 +98,12 @@ public:
     return ptr;
   }
 
+  // Whether the subphrase starts a block, that is, has an absolute pointer
+  bool starts_block(size_t subphrase) const
+  {
+    return subphrase == 0 or pbv[subphrase - 1UL] == 1;
+  }
+
   size_t start_subphrase(size_t subphrase) const
   {
     // sbv has a sentinel 1 past the end of the bitstream, so it's safe to get the length
@@ -91,6 +111,14 @@ public:
     return subphrase != 0 ? sbv.select_1(subphrase) + 1UL : 0;
   }
 
+  // Start of the subphrase following the one holding position, where subphrase = subphrase(position).
+  // Plain bitvectors are probed for the next set bit first: subphrases are usually short, so this
+  // saves the select.
+  size_t next_subphrase_start(size_t position, size_t subphrase) const
+  {
+    return next_start(position, subphrase, std::is_base_of<vectors::sparse, SubphraseBV>{});
+  }
+
   iterator get_iterator(size_t phrase_index, size_t subphrase_idx) const
   {
     return iterator(this, phrase_index, subphrase_idx);
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "match.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace rlz {
+
+namespace optimal {
+
+// Bits taken by each phrase of a parse_keeper / literal_keeper pair. A cost model provides
+// copy(relative, avg_phrase) and literal(avg_phrase), avg_phrase being the expected subphrase length.
+struct bit_cost {
+  size_t rlt_bits;        // Diff of a relative copy (DiffSize)
+  size_t abs_bits;        // Pointer of an absolute copy, which starts a block (PtrSize)
+  size_t sym_bits;        // Packed literal symbol
+  size_t lit_bits;        // Literal length of a subphrase (LitLength)
+  double phrase_penalty;  // Charged to every subphrase: favours fewer, longer phrases (faster decoding)
+
+  bit_cost(size_t rlt_bits, size_t abs_bits, size_t sym_bits, size_t lit_bits, double phrase_penalty = 0.0)
+    : rlt_bits(rlt_bits), abs_bits(abs_bits), sym_bits(sym_bits), lit_bits(lit_bits), phrase_penalty(phrase_penalty)
+  { }
+
+  bit_cost() : bit_cost(4UL, 32UL, 2UL, 4UL) { }
+
+  // Start in the (sparse) subphrase bit-vector, bit in the phrase bit-vector, literal length
+  double subphrase(double avg_phrase) const
+  {
+    return 2.0 + std::log2(std::max(1.0, avg_phrase)) + 1.0 + lit_bits + phrase_penalty;
+  }
+
+  double copy(bool relative, double avg_phrase) const
+  {
+    return subphrase(avg_phrase) + (relative ? rlt_bits : abs_bits);
+  }
+
+  // A literal also pays its share of the empty-copy subphrases that split runs too long for a literal length
+  double literal(double avg_phrase) const
+  {
+    auto max_run = (1UL << lit_bits) - 1UL;
+    return sym_bits + (subphrase(avg_phrase) + rlt_bits) / max_run;
+  }
+};
+
+}
+
+// Minimum-cost RLZAP parse: a shortest path from the first to the last input position, where a
+// literal moves one position ahead and the matching statistic at i allows copies to every
+// position in (i, i + len]. A copy is relative when its delta (ptr - position) is within DiffSize
+// of the delta of the block it falls in, as the parse_keeper builder decides. Every position
+// keeps only the block delta of its cheapest path, so the parse is optimal with respect to
+// the cost model up to this reduction. O(n log n) time. Memory: three words per input position,
+// plus the heap of open copies, up to one 32-byte candidate per position (about 56 bytes per
+// symbol at worst); candidates dominated by the cheapest one (no cheaper, expiring no later) are
+// never kept, which bounds the heap in practice. Match iterators must be random-access, as for
+// parser_rlzap.
+template <typename Cost = optimal::bit_cost>
+class parser_rlzap_optimal {
+public:
+  static constexpr std::int64_t no_anchor = std::numeric_limits<std::int64_t>::min();   // Before the first block
+
+private:
+  static constexpr size_t none = std::numeric_limits<size_t>::max();
+
+  std::int64_t diff_lo;
+  std::int64_t diff_hi;
+  Cost         cost;
+
+  struct candidate {
+    double       cost;
+    size_t       end;     // Last position reachable by the copy
+    size_t       start;
+    std::int64_t anchor;  // Block delta after the copy
+
+    // Ties go to the latest copy, so that the parse does not depend on the heap layout
+    bool operator>(const candidate &other) const
+    {
+      return cost != other.cost ? cost > other.cost : start < other.start;
+    }
+  };
+
+  struct phrase {
+    size_t start;
+    size_t len;
+    bool   copy;
+  };
+
+public:
+  parser_rlzap_optimal(size_t rlt_bits, Cost cost)
+    : diff_lo(-(1LL << (rlt_bits - 1))), diff_hi((1LL << (rlt_bits - 1)) - 1),
+      cost(cost)
+  { }
+
+  parser_rlzap_optimal() : parser_rlzap_optimal(4UL, Cost{}) { }
+
+  const Cost &cost_model() const { return cost; }
+
+  // Expected subphrase length, from a greedy longest-match parse
+  template <typename MatchIt>
+  static double expected_phrase_length(MatchIt match_begin, MatchIt match_end)
+  {
+    const size_t n = std::distance(match_begin, match_end);
+    size_t phrases = 0UL;
+    for (size_t i = 0UL; i < n; i += std::max<size_t>(1UL, std::next(match_begin, i)->len)) { ++phrases; }
+    return phrases > 0UL ? 1.0 * n / phrases : 1.0;
+  }
+
+  // Whether a copy with the given delta can follow a block with delta anchor
+  bool is_relative(std::int64_t anchor, std::int64_t delta) const
+  {
+    return anchor != no_anchor and (delta - anchor) >= diff_lo and (delta - anchor) <= diff_hi;
+  }
+
+  template <
+    typename MatchIt, typename LiteralEvt, typename CopyEvt,
+    typename EndEvt = std::function<void()>
+  >
+  void operator() (
+    MatchIt match_begin, MatchIt match_end,
+    size_t,
+    LiteralEvt literal_func, CopyEvt copy_func, EndEvt end_evt
+  ) const
+  {
+    const size_t n = std::distance(match_begin, match_end);
+    auto ms = [&match_begin] (size_t i) -> match { return *std::next(match_begin, i); };
+
+    const double avg_phrase = expected_phrase_length(match_begin, match_end);
+    const double lit_cost   = cost.literal(avg_phrase);
+
+    // best[j]: cost of parsing the first j symbols; from[j]: start of the copy ending at j (none: literal)
+    std::vector<double>       best(n + 1, 0.0);
+    std::vector<size_t>       from(n + 1, none);
+    std::vector<std::int64_t> anchor(n + 1, no_anchor);
+    std::priority_queue<candidate, std::vector<candidate>, std::greater<candidate>> copies;
+
+    for (size_t j = 0UL; j <= n; ++j) {
+      if (j > 0UL) {
+        best[j]   = best[j - 1] + lit_cost;
+        anchor[j] = anchor[j - 1];
+        while (!copies.empty() and copies.top().end < j) {
+          copies.pop();
+        }
+        if (!copies.empty() and copies.top().cost <= best[j]) {
+          best[j]   = copies.top().cost;
+          from[j]   = copies.top().start;
+          anchor[j] = copies.top().anchor;
+        }
+      }
+      if (j < n and ms(j).len > 0UL) {
+        auto delta    = static_cast<std::int64_t>(ms(j).ptr) - static_cast<std::int64_t>(j);
+        auto relative = is_relative(anchor[j], delta);
+        candidate c {
+          best[j] + cost.copy(relative, avg_phrase), j + ms(j).len, j, relative ? anchor[j] : delta
+        };
+        // A candidate dominated by the top is never chosen: skip it, or drop the tops it dominates
+        if (copies.empty() or c.cost <= copies.top().cost or c.end > copies.top().end) {
+          while (!copies.empty() and copies.top().cost >= c.cost and copies.top().end <= c.end) {
+            copies.pop();
+          }
+          copies.push(c);
+        }
+      }
+    }
+    copies = decltype(copies){};
+    std::vector<double>().swap(best);
+    std::vector<std::int64_t>().swap(anchor);
+
+    // Phrases, right to left; adjacent literals are merged into runs
+    std::vector<phrase> parse;
+    for (size_t j = n; j > 0UL; ) {
+      if (from[j] != none) {
+        parse.push_back(phrase { from[j], j - from[j], true });
+        j = from[j];
+      } else if (!parse.empty() and !parse.back().copy and parse.back().start == j) {
+        --parse.back().start;
+        ++parse.back().len;
+        --j;
+      } else {
+        parse.push_back(phrase { j - 1, 1UL, false });
+        --j;
+      }
+    }
+    for (auto it = parse.rbegin(); it != parse.rend(); ++it) {
+      if (it->copy) {
+        copy_func(it->start, ms(it->start).ptr, it->len);
+      } else {
+        literal_func(it->start, it->len);
+      }
+    }
+    end_evt();
+  }
+};
+
+template <typename Cost>
+constexpr std::int64_t parser_rlzap_optimal<Cost>::no_anchor;
+
+template <typename Cost>
+constexpr size_t parser_rlzap_optimal<Cost>::none;
+
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace rlz { namespace perf {
+
+// Hardware counters of the calling thread, read through perf_event_open. Each event has its own
+// descriptor, so events the kernel refuses (no PMU, perf_event_paranoid, virtual machines) are
+// dropped instead of failing the whole set. Values are scaled when the kernel multiplexes events.
+class counters {
+public:
+  struct value {
+    const char    *name;
+    std::uint64_t count;
+  };
+
+private:
+  struct event {
+    const char    *name;
+    int           fd;
+    std::uint64_t count;
+  };
+
+  std::vector<event> events;
+
+  static int open_event(std::uint32_t type, std::uint64_t config)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type           = type;
+    attr.size           = sizeof(attr);
+    attr.config         = config;
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  void add(const char *name, std::uint32_t type, std::uint64_t config)
+  {
+    auto fd = open_event(type, config);
+    if (fd >= 0) {
+      events.push_back(event { name, fd, 0UL });
+    }
+  }
+
+public:
+  counters()
+  {
+    add("cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    add("instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    add("cache_misses",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    add("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+  }
+
+  counters(const counters&) = delete;
+  counters &operator=(const counters&) = delete;
+
+  ~counters()
+  {
+    for (auto &e : events) {
+      ::close(e.fd);
+    }
+  }
+
+  bool available() const { return not events.empty(); }
+
+  void start()
+  {
+    for (auto &e : events) {
+      ::ioctl(e.fd, PERF_EVENT_IOC_RESET, 0);
+      ::ioctl(e.fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  void stop()
+  {
+    for (auto &e : events) {
+      ::ioctl(e.fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (auto &e : events) {
+      std::uint64_t buf[3] = { 0UL, 0UL, 0UL };  // value, time enabled, time running
+      e.count = 0UL;
+      if (::read(e.fd, buf, sizeof(buf)) == static_cast<ssize_t>(sizeof(buf)) and buf[2] > 0UL) {
+        e.count = buf[2] < buf[1] ? static_cast<std::uint64_t>(1.0 * buf[0] * buf[1] / buf[2]) : buf[0];
+      }
+    }
+  }
+
+  // Counts of the last start()/stop() interval
+  std::vector<value> values() const
+  {
+    std::vector<value> to_ret;
+    for (auto &e : events) {
+      to_ret.push_back(value { e.name, e.count });
+    }
+    return to_ret;
+  }
+};
+
+// Latency distribution of a sample (nearest-rank percentiles)
+struct summary {
+  size_t  samples;
+  double  mean;
+  double  min;
+  double  max;
+  std::vector<std::pair<double, double>> percentiles;   // (percentile, value)
+
+  summary(std::vector<double> values, std::vector<double> pcts = { 50.0, 90.0, 99.0, 99.9 })
+    : samples(values.size()), mean(0.0), min(0.0), max(0.0)
+  {
+    if (values.empty()) {
+      return;
+    }
+    std::sort(values.begin(), values.end());
+    for (auto v : values) { mean += v; }
+    mean /= values.size();
+    min   = values.front();
+    max   = values.back();
+    for (auto p : pcts) {
+      auto rank = static_cast<size_t>(std::ceil(p * values.size() / 100.0 - 1e-9));  // Slack for rounding (99.9 * 1000 / 100 > 999)
+      percentiles.emplace_back(p, values[std::min(values.size(), std::max<size_t>(1UL, rank)) - 1]);
+    }
+  }
+
+  double at(double p) const
+  {
+    for (auto &v : percentiles) {
+      if (v.first == p) {
+        return v.second;
+      }
+    }
+    return 0.0;
+  }
+};
+
+} }
@@ -9,6 +9,7 @@
 #include "check_random.hpp"
 #include "diff_iterator.hpp"
 #include "fractional_container.hpp"
+#include "int_vector.hpp"
 #include "integer_type.hpp"
 #include "sdsl_extensions/int_vector.hpp"
 #include "impl/prefix_sum.hpp"
@@ -23,6 +24,18 @@ private:
   using BitVector = vectors::BitVector<Rep, vectors::algorithms::select>;
   BitVector                       cumulative;
   sdsl::extensions::int_vector<LengthWidth::value()>  lit_lengths;
+
+  // Sets cumulative from lit_lengths, whose sum is length
+  void build_cumulative(size_t length)
+  {
+    typename BitVector::builder build(length + lit_lengths.size() + 1);
+    size_t cumulative_idx = 0U;
+    for (auto i = 0U; i < lit_lengths.size(); ++i) {
+      cumulative_idx += lit_lengths[i] + 1;
+      build.set(cumulative_idx);
+    }
+    cumulative   = BitVector(build.get());
+  }
 public:
 
   static constexpr size_t max_length = (1ULL << LengthWidth::value()) - 1;
@@ -39,17 +52,34 @@ public:
   {
     size_t length = 0U;
     for (auto i : boost::make_iterator_range(begin, end)) { length += i; }
-    typename BitVector::builder build(length + lit_lengths.size() + 1);
-    auto cumulative_idx = 0U;
-    for (auto i = 0U; i < lit_lengths.size(); ++i) {
-      auto len = *begin++;
-      lit_lengths[i] = len;
-      cumulative_idx += len + 1;
-      build.set(cumulative_idx);
-    }
-    cumulative   = BitVector(build.get());
+    std::copy(begin, end, lit_lengths.begin());
+    build_cumulative(length);
   }
 
+  // Collects literal lengths one at a time, directly into the packed representation.
+  class builder {
+  private:
+    ds::growable<sdsl::extensions::int_vector<LengthWidth::value()>> lengths;
+    size_t total;
+  public:
+    builder() : total(0U) { }
+
+    void push_back(size_t len)
+    {
+      assert(len <= max_length);
+      lengths.push_back(len);
+      total += len;
+    }
+
+    fast_cumulative get()
+    {
+      fast_cumulative to_ret;
+      to_ret.lit_lengths = lengths.get();
+      to_ret.build_cumulative(total);
+      return to_ret;
+    }
+  };
+
   size_t access(size_t index) const { return lit_lengths[index]; }
 
   size_t prefix(size_t index) const
@@ -134,9 +164,51 @@ public:
     }
   }
 
+  // Computes sync samples on-line while literal lengths are appended.
+  class builder {
+  private:
+    lit_type lit_lengths;
+    ds::growable<sdsl::int_vector<SamplingSize::value()>> sync_lengths;
+    size_t cumulative;
+  public:
+    builder() : cumulative(0U) { }
+
+    void push_back(size_t len)
+    {
+      if ((lit_lengths.size() % SyncSampling::value()) == 0) {
+        sync_lengths.push_back(cumulative);
+      }
+      lit_lengths.push_back(len);
+      cumulative += len;
+    }
+
+    sampling_cumulative get()
+    {
+      // Same layout as the iterator constructor: one sample more on multiples of SyncSampling
+      if ((lit_lengths.size() % SyncSampling::value()) == 0) {
+        sync_lengths.push_back(cumulative);
+      }
+      sampling_cumulative to_ret;
+      lit_lengths.shrink_to_fit();
+      to_ret.lit_lengths  = std::move(lit_lengths);
+      to_ret.sync_lengths = sync_lengths.get();
+      return to_ret;
+    }
+  };
+
   size_t access(size_t index) const { return lit_lengths[index]; }
 
+  // Sums the lengths following the sync sample a 64-bit word at a time (popcount per bit-plane).
   size_t prefix(size_t index) const
+  {
+    auto smp_idx  = index / SyncSampling::value();
+    auto evals    = index % SyncSampling::value();
+    auto vals_ptr = std::next(lit_lengths.data(), smp_idx * BytesPerSync);
+    return sync_lengths[smp_idx] + impl::word_sum::sum<LengthWidth::value()>(vals_ptr, evals + 1);
+  }
+
+  // Byte-at-a-time table lookup; reference for prefix().
+  size_t prefix_bytewise(size_t index) const
   {
     auto smp_idx  = index / SyncSampling::value();
     auto sum      = sync_lengths[smp_idx];
@@ -216,6 +288,24 @@ public:
     cum_bv = BitVector(build.get());
   }
 
+  // Literal lengths are kept packed until get(), which builds the bit-vector.
+  class builder {
+  private:
+    ds::growable<sdsl::int_vector<LengthWidth::value()>> lengths;
+  public:
+    void push_back(size_t len)
+    {
+      assert(len <= max_length);
+      lengths.push_back(len);
+    }
+
+    cumulative get()
+    {
+      auto packed = lengths.get();
+      return cumulative(packed.begin(), packed.end());
+    }
+  };
+
   size_t access(size_t index) const
   {
     return (index == 0) ? prefix(index) : prefix(index) - prefix(index - 1);
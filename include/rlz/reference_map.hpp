@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <istream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rlz {
+
+// Coordinates of an old reference version in a new one, as aligned blocks: old[o, o + len) is
+// found unchanged at new[n, n + len). Blocks may not overlap in the old reference; parts of it in
+// no block (deleted or changed regions) have no image.
+class reference_map {
+public:
+  struct block {
+    size_t old_start;
+    size_t new_start;
+    size_t len;
+  };
+
+private:
+  std::vector<block> blocks;    // By old_start
+
+public:
+  reference_map() { }
+
+  template <typename BlockIt>
+  reference_map(BlockIt begin, BlockIt end) : blocks(begin, end)
+  {
+    blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [] (const block &b) { return b.len == 0UL; }), blocks.end());
+    std::sort(blocks.begin(), blocks.end(), [] (const block &a, const block &b) { return a.old_start < b.old_start; });
+    for (auto i = 1UL; i < blocks.size(); ++i) {
+      if (blocks[i - 1].old_start + blocks[i - 1].len > blocks[i].old_start) {
+        throw std::logic_error("reference_map: overlapping blocks at " + std::to_string(blocks[i].old_start));
+      }
+    }
+  }
+
+  // Reads whitespace-separated "old_start new_start length" triples
+  static reference_map load(std::istream &in)
+  {
+    std::vector<block> read;
+    block b;
+    while (in >> b.old_start >> b.new_start >> b.len) {
+      read.push_back(b);
+    }
+    if (!in.eof()) {
+      throw std::logic_error("reference_map: malformed block " + std::to_string(read.size() + 1UL));
+    }
+    return reference_map(read.begin(), read.end());
+  }
+
+  // Image of old[pos, pos + len) in the new reference, if it lies in a single block
+  bool translate(size_t pos, size_t len, size_t &to) const
+  {
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), pos, [] (size_t p, const block &b) { return p < b.old_start; });
+    if (it == blocks.begin()) {
+      return false;
+    }
+    --it;
+    if (pos + len > it->old_start + it->len) {
+      return false;
+    }
+    to = it->new_start + (pos - it->old_start);
+    return true;
+  }
+
+  // Symbols of the old reference with an image
+  size_t mapped() const
+  {
+    auto to_ret = 0UL;
+    for (auto &b : blocks) {
+      to_ret += b.len;
+    }
+    return to_ret;
+  }
+
+  // Checks every block against both versions; throws on the first one that does not hold
+  template <typename OldRef, typename NewRef>
+  void verify(const OldRef &old_ref, const NewRef &new_ref) const
+  {
+    for (auto &b : blocks) {
+      if (b.old_start + b.len > old_ref.size() or b.new_start + b.len > new_ref.size()) {
+        throw std::logic_error("reference_map: block at " + std::to_string(b.old_start) + " out of range");
+      }
+      auto old_it = std::next(old_ref.begin(), b.old_start);
+      auto new_it = std::next(new_ref.begin(), b.new_start);
+      for (auto i = 0UL; i < b.len; ++i, ++old_it, ++new_it) {
+        if (*old_it != *new_it) {
+          throw std::logic_error("reference_map: block at " + std::to_string(b.old_start) + " differs at " + std::to_string(b.old_start + i));
+        }
+      }
+    }
+  }
+};
+
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <sdsl/bits.hpp>
+#include <sdsl/int_vector.hpp>
+#include <sdsl/io.hpp>
+#include <sdsl/util.hpp>
+
+#include "match.hpp"
+#include "sa_compute.hpp"
+#include "type_name.hpp"
+
+namespace rlz {
+
+// Matching statistics against a fixed reference, from the suffix array of the reference alone
+// (with its inverse and LCP array). Built once and stored, it matches any later text without
+// sorting the reference again. The reference itself is not kept: callers pass it to operator().
+//
+// The match of position i + 1 starts from the one of i: if that had length l at ptr, the suffix
+// ptr + 1 shares l - 1 symbols with the text, and so do its SA neighbours with LCP >= l - 1. Only
+// those are extended. Short matches, or too many neighbours, fall back to a binary search.
+template <typename Alphabet>
+class reference_matcher {
+private:
+  using Symbol = typename Alphabet::Symbol;
+
+  size_t             ref_len;
+  sdsl::int_vector<> sa;        // Of the reference and a sentinel: sa[0] = ref_len
+  sdsl::int_vector<> isa;
+  sdsl::int_vector<> lcp;
+
+  static constexpr size_t min_known    = 16UL;    // Below it, binary search
+  static constexpr size_t max_scanned  = 64UL;    // SA neighbours scanned before binary search
+
+  // Symbol order of the suffix array (text kinds are sorted as unsigned bytes)
+  static unsigned char key(char s) { return static_cast<unsigned char>(s); }
+
+  template <typename T>
+  static T key(T s) { return s; }
+
+  // Length of the match of text[i, m) with the reference at r, knowing the first known symbols match
+  template <typename RefIt, typename TextIt>
+  size_t extend(RefIt ref, TextIt text, size_t i, size_t m, size_t r, size_t known) const
+  {
+    auto l = known;
+    while (i + l < m and r + l < ref_len and *std::next(text, i + l) == *std::next(ref, r + l)) {
+      ++l;
+    }
+    return l;
+  }
+
+  template <typename RefIt, typename TextIt>
+  match search(RefIt ref, TextIt text, size_t i, size_t m) const
+  {
+    size_t lo = 0UL, hi = ref_len + 1UL, l_lo = 0UL, l_hi = 0UL;
+    while (hi - lo > 1UL) {
+      auto mid = lo + (hi - lo) / 2UL;
+      auto r   = sa[mid];
+      auto l   = extend(ref, text, i, m, r, std::min(l_lo, l_hi));
+      bool text_smaller = i + l == m or (r + l < ref_len and key(*std::next(text, i + l)) < key(*std::next(ref, r + l)));
+      if (text_smaller) {
+        hi   = mid;
+        l_hi = l;
+      } else {
+        lo   = mid;
+        l_lo = l;
+      }
+    }
+    if (hi <= ref_len and l_hi >= l_lo) {
+      return l_hi > 0UL ? match(sa[hi], l_hi) : match();
+    }
+    return l_lo > 0UL ? match(sa[lo], l_lo) : match();
+  }
+
+  // Longest match of text[i, m) among the suffixes sharing known symbols with suffix ptr; false if
+  // there are too many of them
+  template <typename RefIt, typename TextIt>
+  bool neighbours(RefIt ref, TextIt text, size_t i, size_t m, size_t ptr, size_t known, match &best) const
+  {
+    const size_t q = isa[ptr];
+    best = match(ptr, extend(ref, text, i, m, ptr, known));
+    auto scanned = 0UL;
+    auto visit = [&] (size_t j) {
+      auto l = extend(ref, text, i, m, sa[j], known);
+      if (l > best.len) {
+        best = match(sa[j], l);
+      }
+      return ++scanned <= max_scanned;
+    };
+    size_t run = ref_len;
+    for (auto j = q; j > 1UL; --j) {            // Up: lcp[j] is shared by sa[j - 1] and sa[j]
+      run = std::min<size_t>(run, lcp[j]);
+      if (run < known) { break; }
+      if (!visit(j - 1UL)) { return false; }
+    }
+    run = ref_len;
+    for (auto j = q + 1UL; j <= ref_len; ++j) { // Down
+      run = std::min<size_t>(run, lcp[j]);
+      if (run < known) { break; }
+      if (!visit(j)) { return false; }
+    }
+    return true;
+  }
+
+public:
+  reference_matcher() : ref_len(0UL) { }
+
+  template <typename RefIt>
+  reference_matcher(RefIt begin, RefIt end)
+  {
+    std::vector<Symbol> text(begin, end);
+    ref_len = text.size();
+    if (ref_len == 0UL) {
+      throw std::logic_error("reference_matcher: empty reference");
+    }
+    text.push_back(Symbol{});
+    sa_compute<Symbol>{}(text.data(), sa, lcp, text.size());
+    isa = sdsl::int_vector<>(sa.size(), 0UL, sdsl::bits::hi(sa.size()) + 1);
+    for (auto j = 0UL; j < sa.size(); ++j) {
+      isa[sa[j]] = j;
+    }
+    sdsl::util::bit_compress(sa);
+    sdsl::util::bit_compress(lcp);
+  }
+
+  size_t reference_size() const
+  {
+    return ref_len;
+  }
+
+  // Matching statistics of text[0, m) against ref, one match per position
+  template <typename RefIt, typename TextIt>
+  std::vector<match> operator()(RefIt ref, TextIt text, size_t m) const
+  {
+    std::vector<match> to_ret;
+    to_ret.reserve(m);
+    match prev;
+    for (auto i = 0UL; i < m; ++i) {
+      match cur;
+      auto known = prev.len > 0UL ? prev.len - 1UL : 0UL;
+      if (known < min_known or !neighbours(ref, text, i, m, prev.ptr + 1UL, known, cur)) {
+        cur = search(ref, text, i, m);
+      }
+      to_ret.push_back(cur);
+      prev = cur;
+    }
+    return to_ret;
+  }
+
+  size_t serialize(std::ostream& out, sdsl::structure_tree_node* v=nullptr, std::string name="") const
+  {
+    sdsl::structure_tree_node* child = sdsl::structure_tree::add_child(v, name, rlz::util::type_name(*this));
+    size_t written_bytes = 0;
+    written_bytes += sdsl::write_member(ref_len, out, child, "Reference length");
+    written_bytes += sa.serialize(out, child, "SA");
+    written_bytes += isa.serialize(out, child, "ISA");
+    written_bytes += lcp.serialize(out, child, "LCP");
+    sdsl::structure_tree::add_size(child, written_bytes);
+    return written_bytes;
+  }
+
+  void load(std::istream& in)
+  {
+    sdsl::read_member(ref_len, in);
+    sa.load(in);
+    isa.load(in);
+    lcp.load(in);
+  }
+};
+
+template <typename Alphabet>
+constexpr size_t reference_matcher<Alphabet>::min_known;
+
+template <typename Alphabet>
+constexpr size_t reference_matcher<Alphabet>::max_scanned;
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "impl/api.hpp"
+#include "index.hpp"
+#include "index_merge.hpp"
+#include "reference_map.hpp"
+#include "reference_matcher.hpp"
+
+namespace rlz {
+
+// Rebuilds idx against a new version of its reference, without parsing the whole input again.
+//
+// The phrase structure of idx is kept wherever it can be: a subphrase whose copy lies in a single
+// block of map has its pointer translated, and its literals are copied. Runs of the other
+// subphrases (copies from changed or deleted regions) are decompressed and parsed again with
+// parser, from matching statistics against the new reference given by matcher. The old reference
+// is read only to check map and to decompress those runs. If reparsed is not null, it receives
+// the number of input symbols parsed again. bounds, if any, should be those idx was built with;
+// they apply to positions in the whole input, and the blocks of idx are kept.
+template <
+  typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper,
+  typename ParserType
+>
+index<Alphabet, Source, ParseKeeper, LiteralKeeper> rereference(
+  const index<Alphabet, Source, ParseKeeper, LiteralKeeper> &idx,
+  Source reference,
+  const reference_map &map,
+  const reference_matcher<Alphabet> &matcher,
+  ParserType parser,
+  size_t *reparsed = nullptr,
+  build::phrase_bounds bounds = build::phrase_bounds()
+)
+{
+  using Index = index<Alphabet, Source, ParseKeeper, LiteralKeeper>;
+  if (matcher.reference_size() != reference.size()) {
+    throw std::logic_error("rereference: matcher built on a different reference");
+  }
+  map.verify(idx.get_source(), reference);
+
+  index_merger<Index> merger(reference);
+  auto start = 0UL, pending = 0UL, parsed = 0UL;
+  // Parses [pending, end) of the input again
+  auto flush = [&] (size_t end) {
+    if (pending == end) {
+      return;
+    }
+    auto text    = idx(pending, end);
+    auto matches = matcher(reference.begin(), text.data(), text.size());
+    auto part    = impl::construct<Alphabet, ParseKeeper, LiteralKeeper>(
+      text.data(), reference, parser, matches.begin(), matches.end(), bounds.at(pending)
+    );
+    merger.append(part);
+    parsed += end - pending;
+    pending = end;
+  };
+  auto visit = [&] (
+    std::int64_t offset, size_t phrase_len, size_t lit_len, typename Index::LiteralIterator lit, bool block
+  ) {
+    auto copy_len = phrase_len - lit_len;
+    auto to       = start;
+    if (copy_len == 0UL or map.translate(static_cast<size_t>(static_cast<std::int64_t>(start) + offset), copy_len, to)) {
+      flush(start);
+      merger.append_subphrase(static_cast<std::int64_t>(to) - static_cast<std::int64_t>(start), phrase_len, lit_len, lit, block);
+      pending = start + phrase_len;
+    }
+    start += phrase_len;
+  };
+  idx.process_subphrases(visit);
+  flush(start);
+
+  if (reparsed != nullptr) {
+    *reparsed = parsed;
+  }
+  return merger.get();
+}
+
+}
@@ -15,6 +15,7 @@
 #include <sdsl/int_vector.hpp>
 #include <sdsl/io.hpp>
 
+#include "build_stats.hpp"
 #include "cache_settings.hpp"
 #include "sdsl_extensions/serialize.hpp"
 
@@ -108,6 +109,7 @@ public:
     auto f_id  = get_random_id();
     sdsl::cache_config cache {true, cache::global_settings::temp_directory, f_id.c_str()};
     increment();
+    instrument::scoped_stage sa_stage("sa", length * sizeof(T));
     // Store data on disk
     {
       wrapper_t serialize_data(data, length);
@@ -115,8 +117,11 @@ public:
     }
     // Compute SA
     sdsl::construct_sa<width>(cache);
+    sa_stage.stop();
     // Compute LCP
+    instrument::scoped_stage lcp_stage("lcp", length * sizeof(T));
     sdsl::construct_lcp_PHI<width>(cache);
+    lcp_stage.stop();
     // Retrieve SA & LCP
     if (!sdsl::load_from_cache(sa, sdsl::conf::KEY_SA, cache)) {
       throw std::logic_error("Cannot recover SA from cache");
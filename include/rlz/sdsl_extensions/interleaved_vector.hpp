@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <sdsl/bits.hpp>
+#include <sdsl/int_vector.hpp>
+#include <sdsl/iterators.hpp>
+#include <sdsl/util.hpp>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+namespace sdsl { namespace extensions {
+
+//! A plain bit-vector with rank and select metadata stored in-line with the bits.
+/*!
+ * Bits are grouped into 512-bit blocks. Every block is preceded by one 64-bit word holding
+ * the number of ones before the block (37 bits) and the number of ones before each of its
+ * 128-bit sub-blocks (3 x 9 bits), so that rank touches a single 72-byte run of memory.
+ * Select is driven by hints sampling the block of every select_sampling-th one, followed
+ * by a binary search over block counts and a select-in-word.
+ */
+class interleaved_vector {
+public:
+  typedef bit_vector::size_type       size_type;
+  typedef bit_vector::difference_type difference_type;
+  typedef bool                        value_type;
+  typedef random_access_const_iterator<interleaved_vector> const_iterator;
+  typedef const_iterator              iterator;
+
+  static const constexpr size_type block_bits      = 512U;
+  static const constexpr size_type block_words     = block_bits / 64U;
+  static const constexpr size_type stride          = block_words + 1U;
+  static const constexpr size_type rank_bits       = 37U;
+  static const constexpr size_type sub_bits        = 9U;
+  static const constexpr size_type select_sampling = 512U;
+
+private:
+  size_type     m_size;
+  size_type     m_ones;
+  int_vector<64> m_data;
+  int_vector<64> m_hints;
+
+  std::uint64_t meta(size_type block) const { return m_data[block * stride]; }
+
+  std::uint64_t word(size_type word_idx) const
+  {
+    return m_data[(word_idx / block_words) * stride + 1U + (word_idx % block_words)];
+  }
+
+  size_type block_rank(size_type block) const
+  {
+    return meta(block) & bits::lo_set[rank_bits];
+  }
+
+  // Ones before sub-block sub (0..3) of the block described by m
+  static size_type sub_rank(std::uint64_t m, size_type sub)
+  {
+    return (sub == 0U) ? 0U : (m >> (rank_bits + sub_bits * (sub - 1))) & bits::lo_set[sub_bits];
+  }
+
+  static size_type select_in_word(std::uint64_t w, size_type i)
+  {
+#ifdef __BMI2__
+    return __builtin_ctzll(_pdep_u64(1ULL << (i - 1), w));
+#else
+    return bits::sel(w, i);
+#endif
+  }
+
+  void build(const bit_vector &bv)
+  {
+    m_size      = bv.size();
+    auto blocks = m_size / block_bits + 1U;
+    if (m_size >= (1ULL << rank_bits)) {
+      throw std::logic_error("interleaved_vector: too many bits");
+    }
+    m_data = int_vector<64>(blocks * stride, 0U);
+    const std::uint64_t *src = bv.data();
+    auto words = (m_size + 63U) / 64U;
+    size_type ones = 0U;
+    std::vector<std::uint64_t> hints;
+    for (size_type b = 0U; b < blocks; ++b) {
+      std::uint64_t m = ones;
+      size_type in_block = 0U;
+      for (size_type w = 0U; w < block_words; ++w) {
+        auto w_idx = b * block_words + w;
+        std::uint64_t value = w_idx < words ? src[w_idx] : 0U;
+        if (w_idx + 1U == words and (m_size % 64U) != 0U) {
+          value &= bits::lo_set[m_size % 64U];
+        }
+        if (w > 0U and (w % 2U) == 0U) {
+          m |= static_cast<std::uint64_t>(in_block) << (rank_bits + sub_bits * (w / 2U - 1U));
+        }
+        m_data[b * stride + 1U + w] = value;
+        auto cnt = bits::cnt(value);
+        // Record the block of every select_sampling-th one (1-based: 1, 1 + S, 1 + 2S, ...)
+        for (auto next = hints.size() * select_sampling + 1U; ones + in_block + cnt >= next; next += select_sampling) {
+          hints.push_back(b);
+        }
+        in_block += cnt;
+      }
+      m_data[b * stride] = m;
+      ones += in_block;
+    }
+    m_ones  = ones;
+    m_hints = int_vector<64>(hints.size() + 1U, blocks - 1U);
+    std::copy(hints.begin(), hints.end(), m_hints.begin());
+  }
+
+public:
+
+  interleaved_vector() : m_size(0U), m_ones(0U), m_data(stride, 0U), m_hints(1U, 0U) { }
+
+  explicit interleaved_vector(const bit_vector &bv) { build(bv); }
+
+  size_type size() const { return m_size; }
+
+  size_type ones() const { return m_ones; }
+
+  value_type operator[](size_type idx) const
+  {
+    return (word(idx / 64U) >> (idx % 64U)) & 1U;
+  }
+
+  std::uint64_t get_int(size_type idx, const uint8_t len = 64) const
+  {
+    if (len == 0U) {
+      return 0U;
+    }
+    auto offset = idx % 64U;
+    std::uint64_t value = word(idx / 64U) >> offset;
+    if (offset + len > 64U) {
+      value |= word(idx / 64U + 1U) << (64U - offset);
+    }
+    return value & bits::lo_set[len];
+  }
+
+  //! Number of ones in [0, idx)
+  size_type rank_1(size_type idx) const
+  {
+    auto block  = idx / block_bits;
+    auto offset = idx % block_bits;
+    auto m      = meta(block);
+    auto base   = block * stride + 1U;
+    auto w      = (offset / 128U) * 2U;
+    size_type r = (m & bits::lo_set[rank_bits]) + sub_rank(m, offset / 128U);
+    if ((offset % 128U) >= 64U) {
+      r += bits::cnt(m_data[base + w++]);
+    }
+    return r + bits::cnt(m_data[base + w] & bits::lo_set[offset % 64U]);
+  }
+
+  //! Position of the i-th one (1-based)
+  size_type select_1(size_type i) const
+  {
+    assert(i > 0U and i <= m_ones);
+    auto sample = (i - 1U) / select_sampling;
+    size_type lo = m_hints[sample], hi = m_hints[sample + 1U];
+    // Last block in [lo, hi] with less than i ones before it
+    while (lo < hi) {
+      auto mid = lo + (hi - lo + 1U) / 2U;
+      if (block_rank(mid) < i) {
+        lo = mid;
+      } else {
+        hi = mid - 1U;
+      }
+    }
+    auto m    = meta(lo);
+    auto left = i - (m & bits::lo_set[rank_bits]);
+    size_type sub = 3U;
+    while (sub > 0U and sub_rank(m, sub) >= left) {
+      --sub;
+    }
+    left -= sub_rank(m, sub);
+    auto base = lo * stride + 1U + sub * 2U;
+    auto cnt  = bits::cnt(m_data[base]);
+    if (cnt < left) {
+      left -= cnt;
+      return lo * block_bits + (sub * 2U + 1U) * 64U + select_in_word(m_data[base + 1U], left);
+    }
+    return lo * block_bits + sub * 128U + select_in_word(m_data[base], left);
+  }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size()); }
+
+  void swap(interleaved_vector &other)
+  {
+    if (this != &other) {
+      std::swap(m_size, other.m_size);
+      std::swap(m_ones, other.m_ones);
+      m_data.swap(other.m_data);
+      m_hints.swap(other.m_hints);
+    }
+  }
+
+  size_type serialize(std::ostream& out, structure_tree_node* v=nullptr, std::string name="") const
+  {
+    structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+    size_type written_bytes = 0;
+    written_bytes += write_member(m_size, out, child, "size");
+    written_bytes += write_member(m_ones, out, child, "ones");
+    written_bytes += m_data.serialize(out, child, "data");
+    written_bytes += m_hints.serialize(out, child, "select_hints");
+    structure_tree::add_size(child, written_bytes);
+    return written_bytes;
+  }
+
+  void load(std::istream& in)
+  {
+    read_member(m_size, in);
+    read_member(m_ones, in);
+    m_data.load(in);
+    m_hints.load(in);
+  }
+};
+
+//! Rank support for interleaved_vector: the metadata lives in the vector itself.
+class rank_support_interleaved {
+public:
+  typedef interleaved_vector::size_type size_type;
+  typedef interleaved_vector            bit_vector_type;
+private:
+  const bit_vector_type* m_v;
+public:
+  explicit rank_support_interleaved(const bit_vector_type* v=nullptr) { set_vector(v); }
+
+  size_type rank(size_type i) const { return m_v->rank_1(i); }
+  size_type operator()(size_type i) const { return rank(i); }
+  size_type size() const { return m_v->size(); }
+
+  void set_vector(const bit_vector_type* v=nullptr) { m_v = v; }
+  void swap(rank_support_interleaved&) { }
+
+  void load(std::istream&, const bit_vector_type* v=nullptr) { set_vector(v); }
+
+  size_type serialize(std::ostream& out, structure_tree_node* v=nullptr, std::string name="") const
+  {
+    return serialize_empty_object(out, v, name, this);
+  }
+};
+
+//! Select support for interleaved_vector: hints are stored with the vector.
+class select_support_interleaved {
+public:
+  typedef interleaved_vector::size_type size_type;
+  typedef interleaved_vector            bit_vector_type;
+private:
+  const bit_vector_type* m_v;
+public:
+  explicit select_support_interleaved(const bit_vector_type* v=nullptr) { set_vector(v); }
+
+  size_type select(size_type i) const { return m_v->select_1(i); }
+  size_type operator()(size_type i) const { return select(i); }
+  size_type size() const { return m_v->size(); }
+
+  void set_vector(const bit_vector_type* v=nullptr) { m_v = v; }
+  void swap(select_support_interleaved&) { }
+
+  void load(std::istream&, const bit_vector_type* v=nullptr) { set_vector(v); }
+
+  size_type serialize(std::ostream& out, structure_tree_node* v=nullptr, std::string name="") const
+  {
+    return serialize_empty_object(out, v, name, this);
+  }
+};
+
+} }
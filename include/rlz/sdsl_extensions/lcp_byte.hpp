@@ -22,11 +22,12 @@
 
 #include <sdsl/int_vector.hpp>
 #include <sdsl/iterators.hpp>
+#include <sdsl/rank_support_v5.hpp>
+#include <sdsl/util.hpp>
 
 #include "../int_vector.hpp"
 #include "../type_name.hpp"
 
-#include <algorithm> // for lower_bound
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -46,6 +47,17 @@ struct lcp_config<true> {
     template <size_t T>
     using container = rlz::ds::int_vector<T>;
 
+    // Signed containers already grow geometrically on push_back
+    template <size_t T>
+    using appender = rlz::ds::int_vector<T>;
+
+    template <size_t T>
+    static container<T> seal(appender<T> &v)
+    {
+      v.shrink_to_fit();
+      return std::move(v);
+    }
+
     constexpr static int high() { return 127;  }
     constexpr static int low()  { return -128; }
 };
@@ -55,13 +67,22 @@ struct lcp_config<false> {
     template <size_t T>
     using container = sdsl::int_vector<T>;
 
+    template <size_t T>
+    using appender = rlz::ds::growable<sdsl::int_vector<T>>;
+
+    template <size_t T>
+    static container<T> seal(appender<T> &v)
+    {
+      return v.get();
+    }
+
     constexpr static size_t high() { return 255U; }
     constexpr static size_t low()  { return 0U; }
 };
 
 }
 
-template<typename Symbol, size_t max_exception_log = 0UL>
+template<typename Symbol>
 class signed_lcp_byte
 {
 public:
@@ -86,15 +107,94 @@ private:
 
   Container<8UL>            m_small_lcp;             // vector for LCP values in [-128, 127]
   Container<symbol_width>   m_big_lcp;               // vector for LCP values outside [-128, 127]
-  sdsl::int_vector<max_exception_log> m_big_lcp_idx; // index of LCP entries in the LCP array
+  sdsl::bit_vector          m_big_marker;            // marks LCP entries stored in m_big_lcp (empty if none)
+  sdsl::rank_support_v5<>   m_big_rank;              // maps a marked entry to its m_big_lcp index
+
+  // Marker and rank support are only kept (and stored) when there are exceptions
+  void seal_marker()
+  {
+    if (m_big_lcp.size() == 0) {
+      m_big_marker = sdsl::bit_vector();
+    }
+    sdsl::util::init_support(m_big_rank, &m_big_marker);
+  }
 public:
+  //! Incremental constructor: values are appended one at a time.
+  class builder {
+    using Config = impl::lcp_config<std::is_signed<Symbol>::value>;
+    template <size_t T>
+    using Appender = typename Config::template appender<T>;
+
+    Appender<8UL>                       small_lcp;
+    Appender<symbol_width>              big_lcp;
+    rlz::ds::growable<sdsl::bit_vector> big_marker;
+  public:
+    void push_back(Symbol l)
+    {
+      if (l >= small_low and l < small_high) {
+        small_lcp.push_back(l);
+        big_marker.push_back(0U);
+      } else {
+        small_lcp.push_back(small_high);
+        big_lcp.push_back(l);
+        big_marker.push_back(1U);
+      }
+    }
+
+    signed_lcp_byte get()
+    {
+      signed_lcp_byte to_ret;
+      to_ret.m_small_lcp  = Config::template seal<8UL>(small_lcp);
+      to_ret.m_big_lcp    = Config::template seal<symbol_width>(big_lcp);
+      to_ret.m_big_marker = big_marker.get();
+      to_ret.seal_marker();
+      return to_ret;
+    }
+  };
+
   //! Default Constructor
-  signed_lcp_byte() { };
+  signed_lcp_byte() { m_big_rank.set_vector(&m_big_marker); }
+
+  //! Copy and move constructors: the rank support must point to our own marker.
+  signed_lcp_byte(const signed_lcp_byte &other)
+    : m_small_lcp(other.m_small_lcp), m_big_lcp(other.m_big_lcp),
+      m_big_marker(other.m_big_marker), m_big_rank(other.m_big_rank)
+  {
+    m_big_rank.set_vector(&m_big_marker);
+  }
+
+  signed_lcp_byte(signed_lcp_byte &&other)
+    : m_small_lcp(std::move(other.m_small_lcp)), m_big_lcp(std::move(other.m_big_lcp)),
+      m_big_marker(std::move(other.m_big_marker)), m_big_rank(std::move(other.m_big_rank))
+  {
+    m_big_rank.set_vector(&m_big_marker);
+  }
+
+  signed_lcp_byte &operator=(const signed_lcp_byte &other)
+  {
+    if (this != &other) {
+      signed_lcp_byte temp(other);
+      *this = std::move(temp);
+    }
+    return *this;
+  }
+
+  signed_lcp_byte &operator=(signed_lcp_byte &&other)
+  {
+    if (this != &other) {
+      m_small_lcp  = std::move(other.m_small_lcp);
+      m_big_lcp    = std::move(other.m_big_lcp);
+      m_big_marker = std::move(other.m_big_marker);
+      m_big_rank   = std::move(other.m_big_rank);
+      m_big_rank.set_vector(&m_big_marker);
+    }
+    return *this;
+  }
 
   //! Constructor
   template <typename ValueIt>
   signed_lcp_byte(ValueIt begin, ValueIt end)
-    : m_small_lcp(std::distance(begin, end), 0)
+    : m_small_lcp(std::distance(begin, end), 0), m_big_marker(m_small_lcp.size(), 0)
   {
     Symbol l = 0, big_sum = 0;
 
@@ -104,20 +204,19 @@ public:
         m_small_lcp[i] = l;
       } else {
         m_small_lcp[i] = small_high;
+        m_big_marker[i] = 1;
         ++big_sum;
       }
     }
-    m_big_lcp     = Container<symbol_width>(big_sum, 0);
-    m_big_lcp_idx = sdsl::int_vector<max_exception_log>(big_sum, 0);
+    m_big_lcp = Container<symbol_width>(big_sum, 0);
 
     for (size_t i = 0, ii = 0; i<m_small_lcp.size(); ++i) {
       l = *std::next(begin, i);
       if (l < small_low or l >= small_high) {
-        m_big_lcp[ii] = l;
-        m_big_lcp_idx[ii] = i;
-        ++ii;
+        m_big_lcp[ii++] = l;
       }
     }
+    seal_marker();
   }
 
   //! Number of elements in the instance.
@@ -152,19 +251,14 @@ public:
 
   //! []-operator
   /*! \param i Index of the value. \f$ i \in [0..size()-1]\f$.
-   * Time complexity: O(1) for small and O(log n) for large values
+   * Time complexity: O(1); large values are located by ranking their marker.
    */
   Symbol operator[](size_t i) const
   {
     if (m_small_lcp[i] != small_high) {
       return m_small_lcp[i];
     } else {
-      size_t idx = std::lower_bound(
-        m_big_lcp_idx.begin(),
-        m_big_lcp_idx.end(),
-        i
-      ) - m_big_lcp_idx.begin();
-      return m_big_lcp[idx];
+      return m_big_lcp[m_big_rank(i)];
     }
   }
 
@@ -175,7 +269,10 @@ public:
     size_t written_bytes = 0;
     written_bytes += m_small_lcp.serialize(out, child, "small_lcp");
     written_bytes += m_big_lcp.serialize(out, child, "large_lcp");
-    written_bytes += m_big_lcp_idx.serialize(out, child, "large_lcp_idx");
+    if (m_big_lcp.size() > 0) {
+      written_bytes += m_big_marker.serialize(out, child, "large_lcp_marker");
+      written_bytes += m_big_rank.serialize(out, child, "large_lcp_rank");
+    }
     structure_tree::add_size(child, written_bytes);
     return written_bytes;
   }
@@ -184,17 +281,23 @@ public:
   void load(std::istream& in) {
     m_small_lcp.load(in);
     m_big_lcp.load(in);
-    m_big_lcp_idx.load(in);
+    if (m_big_lcp.size() > 0) {
+      m_big_marker.load(in);
+      m_big_rank.load(in, &m_big_marker);
+    } else {
+      m_big_marker = sdsl::bit_vector();
+      sdsl::util::init_support(m_big_rank, &m_big_marker);
+    }
   }
 };
 
-template<typename Symbol, size_t max_exception_log>
-constexpr const size_t signed_lcp_byte<Symbol, max_exception_log>::symbol_width;
+template<typename Symbol>
+constexpr const size_t signed_lcp_byte<Symbol>::symbol_width;
 
-template<typename Symbol, size_t max_exception_log>
-constexpr const Symbol signed_lcp_byte<Symbol, max_exception_log>::small_low;
-template<typename Symbol, size_t max_exception_log>
-constexpr const Symbol signed_lcp_byte<Symbol, max_exception_log>::small_high;
+template<typename Symbol>
+constexpr const Symbol signed_lcp_byte<Symbol>::small_low;
+template<typename Symbol>
+constexpr const Symbol signed_lcp_byte<Symbol>::small_high;
 
 } // end namespace extensions
 } // end namespace sdsl
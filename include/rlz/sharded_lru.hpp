@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rlz { namespace cache {
+
+struct lru_stats {
+  size_t hits;
+  size_t misses;
+  size_t evictions;
+};
+
+// Bounded LRU map split into independently locked shards, so that concurrent lookups on
+// different keys rarely contend. Values are handed out as shared pointers: an entry evicted
+// while in use stays alive until its last user drops it.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class sharded_lru {
+public:
+  using value_ptr = std::shared_ptr<const Value>;
+
+private:
+  struct shard {
+    using entry = std::pair<Key, value_ptr>;
+    std::mutex                                                      lock;
+    std::list<entry>                                                order;   // Most recent first
+    std::unordered_map<Key, typename std::list<entry>::iterator, Hash> map;
+  };
+
+  std::vector<std::unique_ptr<shard>> shards;
+  size_t                              shard_capacity;
+  Hash                                hash;
+  std::atomic<size_t>                 hits;
+  std::atomic<size_t>                 misses;
+  std::atomic<size_t>                 evictions;
+
+  shard &shard_of(const Key &k)
+  {
+    return *shards[hash(k) % shards.size()];
+  }
+
+public:
+  // Holds at most capacity entries (at least one per shard).
+  sharded_lru(size_t capacity, size_t no_shards = 16UL)
+    : shard_capacity(std::max<size_t>(1UL, capacity / std::max<size_t>(1UL, no_shards))),
+      hits(0UL), misses(0UL), evictions(0UL)
+  {
+    for (auto i = 0UL; i < std::max<size_t>(1UL, no_shards); ++i) {
+      shards.emplace_back(new shard());
+    }
+  }
+
+  // Returns the cached value for k, calling load() to compute it on a miss. Loading happens
+  // outside the shard lock; if two threads race on the same key, the first insertion wins.
+  template <typename Loader>
+  value_ptr get(const Key &k, Loader load)
+  {
+    auto &s = shard_of(k);
+    {
+      std::lock_guard<std::mutex> guard(s.lock);
+      auto it = s.map.find(k);
+      if (it != s.map.end()) {
+        s.order.splice(s.order.begin(), s.order, it->second);
+        ++hits;
+        return it->second->second;
+      }
+    }
+    ++misses;
+    value_ptr loaded = std::make_shared<const Value>(load());
+
+    std::lock_guard<std::mutex> guard(s.lock);
+    auto it = s.map.find(k);
+    if (it != s.map.end()) {
+      return it->second->second;
+    }
+    s.order.emplace_front(k, loaded);
+    s.map[k] = s.order.begin();
+    while (s.order.size() > shard_capacity) {
+      s.map.erase(s.order.back().first);
+      s.order.pop_back();
+      ++evictions;
+    }
+    return loaded;
+  }
+
+  void clear()
+  {
+    for (auto &s : shards) {
+      std::lock_guard<std::mutex> guard(s->lock);
+      s->order.clear();
+      s->map.clear();
+    }
+  }
+
+  size_t capacity() const { return shard_capacity * shards.size(); }
+
+  lru_stats stats() const
+  {
+    return lru_stats { hits.load(), misses.load(), evictions.load() };
+  }
+
+  void reset_stats()
+  {
+    hits = 0UL;
+    misses = 0UL;
+    evictions = 0UL;
+  }
+};
+
+} }
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/io.hpp>
+
+#include "bit_vectors.hpp"
+#include "integer_type.hpp"
+
+namespace rlz {
+
+namespace estimate {
+
+// Serialized size, in bytes, of every component of an index built with a given DiffSize,
+// literal length and sampling interval
+struct component_sizes {
+  size_t diff_bits;
+  size_t lit_bits;
+  size_t sample;
+  size_t blocks;          // Absolute pointers
+  size_t subphrases;
+
+  size_t phrase_bv;       // parse_keeper
+  size_t subphrase_bv;
+  size_t ptrs;
+  size_t diffs;
+  size_t lit_lengths;     // literal_split_keeper with a sampling_cumulative prefix
+  size_t lit_samples;
+  size_t literals;
+
+  size_t parse() const { return phrase_bv + subphrase_bv + ptrs + diffs; }
+  size_t literal() const { return lit_lengths + lit_samples + literals; }
+  size_t total() const { return parse() + literal(); }
+
+  // Adds the components of another parse with the same configuration, as for separately parsed parts
+  component_sizes &operator+=(const component_sizes &other)
+  {
+    blocks       += other.blocks;
+    subphrases   += other.subphrases;
+    phrase_bv    += other.phrase_bv;
+    subphrase_bv += other.subphrase_bv;
+    ptrs         += other.ptrs;
+    diffs        += other.diffs;
+    lit_lengths  += other.lit_lengths;
+    lit_samples  += other.lit_samples;
+    literals     += other.literals;
+    return *this;
+  }
+};
+
+// sdsl::int_vector with fixed width: size header, then whole words
+inline size_t int_vector_bytes(size_t elements, size_t width)
+{
+  return sizeof(std::uint64_t) + (elements * width + 63UL) / 64UL * sizeof(std::uint64_t);
+}
+
+// ds::int_vector filled by push_back, as the parse_keeper builder does: storage grows by the
+// default load factor from 128 elements and is serialized with its spare capacity
+inline size_t grown_int_vector_bytes(size_t elements, size_t width)
+{
+  size_t capacity = 0UL;
+  while (capacity < elements) {
+    capacity = std::max<size_t>(capacity * values::Rational<15, 10>::value(), 128UL);
+  }
+  return int_vector_bytes(capacity, width) + sizeof(size_t);
+}
+
+// fractional_byte_container: element count, then packed bytes
+inline size_t fractional_bytes(size_t elements, size_t width)
+{
+  return sizeof(size_t) + (elements * width + 7UL) / 8UL;
+}
+
+// sampling_cumulative sync samples (32 bits each): one every sample lengths, plus the final one
+inline size_t sample_bytes(size_t lengths, size_t sample)
+{
+  return int_vector_bytes(lengths / sample + 1UL, 32UL);
+}
+
+}
+
+// Computes the exact size of every component of parse_keeper / literal_split_keeper indexes,
+// for several DiffSizes and literal lengths at once, from a single parse and without building
+// them. It consumes the parser events as the coordinator does: phrases are committed once, then
+// the split_as_block decisions of each DiffSize and the literal splits (can_split) of each literal
+// length are replayed on them. Only the bit-vectors, whose select structures depend on their
+// content, and the literals (shared by every configuration) are actually built.
+// Event positions are absolute: a parse of a part of the input starting at origin passes the
+// text of that part, and the sizes are the ones of an index of that part alone.
+template <
+  typename Alphabet,
+  typename SymbolIt       = typename Alphabet::Symbol*,
+  typename PtrSize        = values::Size<32UL>,
+  typename PhraseBVRep    = vectors::dense,
+  typename SubphraseBVRep = vectors::sparse
+>
+class size_estimator {
+private:
+  // As in parse_keeper
+  using PhraseBV    = vectors::BitVector<PhraseBVRep, vectors::algorithms::rank>;
+  using SubphraseBV = vectors::BitVector<SubphraseBVRep, vectors::algorithms::rank, vectors::algorithms::select, vectors::algorithms::bitset>;
+  using Packer      = typename Alphabet::Packer;
+
+  // A copy and the literal run following it, before literal splits
+  struct phrase {
+    size_t         start;
+    std::ptrdiff_t delta;
+    size_t         copy;
+    size_t         literal;
+  };
+
+  // Block decisions of the parse_keeper builder for one DiffSize
+  struct block_tracker {
+    size_t            bits;
+    std::int64_t      low;
+    std::int64_t      high;
+    std::int64_t      block_delta;
+    size_t            blocks;
+    std::vector<bool> is_block;   // One per committed phrase
+  };
+
+  const SymbolIt              text;
+  size_t                      origin;
+  std::vector<size_t>         widths;
+  std::vector<block_tracker>  trackers;
+  std::vector<phrase>         phrases;
+  bool                        pending;
+  phrase                      previous;
+  size_t                      length;
+  bool                        finished;
+  typename Packer::builder    literal_build;
+  size_t                      literal_bytes;
+
+  void commit(const phrase &p)
+  {
+    for (auto &t : trackers) {
+      auto delta_delta = p.delta - t.block_delta;
+      bool block = phrases.empty() or (p.copy > 0 and (delta_delta < t.low or delta_delta > t.high));
+      if (block) {
+        t.block_delta = p.delta;
+        ++t.blocks;
+      }
+      t.is_block.push_back(block);
+    }
+    phrases.push_back(p);
+    length = p.start + p.copy + p.literal;
+  }
+
+  // Subphrases of a phrase when literal runs are at most max_literal long
+  static size_t subphrases(const phrase &p, size_t max_literal)
+  {
+    if (p.copy > 0) {
+      return p.literal == 0 ? 1UL : 1UL + (p.literal - 1UL) / max_literal;
+    }
+    return (p.literal + max_literal - 1UL) / max_literal;
+  }
+
+public:
+  size_estimator(const SymbolIt text, std::vector<size_t> diff_sizes, std::vector<size_t> literal_widths, size_t origin = 0UL)
+    : text(text), origin(origin), widths(literal_widths), pending(false), previous(phrase { 0UL, 0, 0UL, 0UL }),
+      length(0UL), finished(false), literal_bytes(0UL)
+  {
+    for (auto bits : diff_sizes) {
+      if (bits < 1UL or bits > 32UL) {
+        throw std::logic_error("Unsupported subphrase pointer size");
+      }
+      std::int64_t high = (1LL << (bits - 1)) - 1;
+      trackers.push_back(block_tracker { bits, -high - 1, high, 0, 0UL, std::vector<bool>() });
+    }
+    for (auto w : widths) {
+      if (w < 1UL or w > 8UL) {
+        throw std::logic_error("Unsupported literal length");
+      }
+    }
+  }
+
+  void copy_evt(size_t position, size_t ptr, size_t len)
+  {
+    if (pending) {
+      commit(previous);
+    }
+    previous = phrase { position - origin, static_cast<std::ptrdiff_t>(ptr) - static_cast<std::ptrdiff_t>(position), len, 0UL };
+    pending  = true;
+  }
+
+  void literal_evt(size_t position, size_t len)
+  {
+    phrase p { position - origin, 0, 0UL, 0UL };
+    if (pending) {
+      p = previous;
+    }
+    p.literal = len;
+    commit(p);
+    pending = false;
+    literal_build.append(std::next(text, position - origin), std::next(text, position - origin + len));
+  }
+
+  void end_evt()
+  {
+    if (pending) {
+      commit(previous);
+      pending = false;
+    }
+    auto literals = literal_build.get();
+    literal_bytes = sdsl::size_in_bytes(literals);
+    finished      = true;
+  }
+
+  size_t parsed_length() const { return length; }
+
+  // Sizes of every (DiffSize, literal length, sampling interval) combination
+  std::vector<estimate::component_sizes> sizes(const std::vector<size_t> &samples) const
+  {
+    if (not finished) {
+      throw std::logic_error("size_estimator: parse not finished");
+    }
+    if (phrases.empty()) {
+      throw std::logic_error("size_estimator: empty parse");
+    }
+    std::vector<estimate::component_sizes> to_ret;
+    for (auto w : widths) {
+      const size_t max_literal = (1UL << w) - 1UL;
+
+      // Last position of every subphrase: the ones of the subphrase bit-vector
+      std::vector<size_t> ends;
+      std::vector<size_t> first_sub;    // Index of the first subphrase of each phrase
+      first_sub.reserve(phrases.size());
+      for (auto &p : phrases) {
+        first_sub.push_back(ends.size());
+        auto left = p.literal;
+        auto end  = p.start + p.copy;
+        for (auto s = subphrases(p, max_literal); s > 0UL; --s) {
+          auto lit = std::min(left, max_literal);
+          end  += lit;
+          left -= lit;
+          ends.push_back(end - 1UL);
+        }
+      }
+      const size_t m = ends.size();
+      size_t subphrase_bv = 0UL;
+      {
+        SubphraseBV sbv(std::make_tuple(ends.begin(), ends.end(), length + 1UL));
+        subphrase_bv = sdsl::size_in_bytes(sbv);
+      }
+      std::vector<size_t>().swap(ends);
+
+      for (auto &t : trackers) {
+        // Bit i tells whether subphrase i + 1 starts a block; the last one is a sentinel
+        sdsl::bit_vector indicator(m, 0);
+        for (auto i = 1UL; i < phrases.size(); ++i) {
+          indicator[first_sub[i] - 1UL] = t.is_block[i];
+        }
+        indicator[m - 1UL] = 1;
+        PhraseBV pbv(std::move(indicator));
+        auto phrase_bv = sdsl::size_in_bytes(pbv);
+
+        for (auto s : samples) {
+          estimate::component_sizes c;
+          c.diff_bits    = t.bits;
+          c.lit_bits     = w;
+          c.sample       = s;
+          c.blocks       = t.blocks;
+          c.subphrases   = m;
+          c.phrase_bv    = phrase_bv;
+          c.subphrase_bv = subphrase_bv;
+          c.ptrs         = estimate::grown_int_vector_bytes(t.blocks, PtrSize::value());
+          c.diffs        = estimate::grown_int_vector_bytes(1UL + m - t.blocks, t.bits);   // Left sentinel
+          c.lit_lengths  = estimate::fractional_bytes(m, w);
+          c.lit_samples  = estimate::sample_bytes(m, s);
+          c.literals     = literal_bytes;
+          to_ret.push_back(c);
+        }
+      }
+    }
+    return to_ret;
+  }
+};
+
+// Runs parser on the matching statistics of input and returns the sizes of every combination of
+// the given DiffSizes, literal lengths and sampling intervals.
+template <typename Alphabet, typename ParseType, typename SymbolIt, typename MatchIt>
+std::vector<estimate::component_sizes> estimate_sizes(
+  SymbolIt input, size_t reference_len, ParseType parser, MatchIt m_begin, MatchIt m_end,
+  std::vector<size_t> diff_sizes, std::vector<size_t> literal_widths, std::vector<size_t> samples
+)
+{
+  size_estimator<Alphabet, SymbolIt> est(input, diff_sizes, literal_widths);
+  auto copy_evt    = [&] (size_t position, size_t ptr, size_t len) { est.copy_evt(position, ptr, len); };
+  auto literal_evt = [&] (size_t position, size_t length) { est.literal_evt(position, length); };
+  auto end_evt     = [&] () { est.end_evt(); };
+  parser(m_begin, m_end, reference_len, literal_evt, copy_evt, end_evt);
+  return est.sizes(samples);
+}
+
+}
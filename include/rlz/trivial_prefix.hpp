@@ -58,6 +58,21 @@ public:
   {
   }
 
+  class builder {
+    std::uint32_t phrases;
+  public:
+    builder() : phrases(0U) { }
+
+    void push_back(size_t) { ++phrases; }
+
+    trivial get()
+    {
+      trivial to_ret;
+      to_ret.phrases = phrases;
+      return to_ret;
+    }
+  };
+
   size_t access(size_t index) const { return 1UL; }
 
   size_t prefix(size_t index) const { return index + 1; }
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace rlz { namespace perf {
+
+// Draws region ranks following a Zipf distribution, by inverting its cumulative distribution.
+class zipf_gen {
+  std::vector<double> cdf;
+  std::uniform_real_distribution<double> unif;
+public:
+  zipf_gen(size_t n, double s) : cdf(n), unif(0.0, 1.0)
+  {
+    double sum = 0.0;
+    for (auto i = 0UL; i < n; ++i) {
+      sum   += 1.0 / std::pow(i + 1.0, s);
+      cdf[i] = sum;
+    }
+    for (auto &c : cdf) { c /= sum; }
+  }
+
+  template <typename Rng>
+  size_t operator()(Rng &rg)
+  {
+    auto it = std::lower_bound(cdf.begin(), cdf.end(), unif(rg));
+    return std::min<size_t>(std::distance(cdf.begin(), it), cdf.size() - 1);
+  }
+};
+
+} }
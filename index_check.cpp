@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstdlib>
 #include <iostream>
 
 #include <api.hpp>
@@ -64,10 +65,12 @@ int main(int argc, char **argv)
     desc.add_options()
         ("index,i", po::value<string>()->required(),
          "Index file, to be checked against reference and input.")
-        ("input,s", po::value<string>()->required(),
+        ("input,s", po::value<string>(),
          "Input file, that is, the indexed file.")
-        ("reference,r", po::value<string>()->required(),
-         "Reference file.");
+        ("reference,r", po::value<string>(),
+         "Reference file.")
+        ("verify,v",
+         "Only check the index header and section checksums, without decompressing.");
 
     po::positional_options_description pd;
     pd.add("input", 1).add("reference", 1).add("index", 1);
@@ -81,6 +84,18 @@ int main(int argc, char **argv)
 
     // Collect parameters
     string index      = vm["index"].as<string>();
+    if (vm.count("verify")) {
+      auto hdr = rlz::serialize::verify(index.c_str());
+      std::cout << "Index " << index << ": format version " << hdr.version
+                << ", configuration " << hdr.id
+                << ", reference " << hdr.reference_len << " symbols"
+                << ", parse " << hdr.sections[0].length << " bytes"
+                << ", literals " << hdr.sections[1].length << " bytes: checksums OK" << std::endl;
+      return EXIT_SUCCESS;
+    }
+    if (!vm.count("input") or !vm.count("reference")) {
+      throw std::runtime_error("Input and reference files are required unless --verify is given");
+    }
     string input      = vm["input"].as<string>();
     string reference  = vm["reference"].as<string>();
 
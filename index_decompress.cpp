@@ -1,62 +1,12 @@
-#include <array>
 #include <cstdlib>
 #include <cstdint>
 #include <fstream>
+#include <iostream>
 #include <limits>
 
 #include <boost/program_options.hpp>
 
-#include <api.hpp>
-#include <io.hpp>
-
-std::ostream &operator<<(std::ostream &s, const std::vector<char> &v)
-{
-  s << std::string(v.data(), v.size());
-  return s;
-}
-
-template <typename T>
-std::ostream &operator<<(std::ostream &s, const std::vector<T> &v)
-{
-  for (auto i : v) {
-    s << i << " ";
-  }
-  return s;
-}
-
-template <typename T>
-struct GetSymbol { };
-
-template <typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper>
-struct GetSymbol<rlz::index<Alphabet, Source, ParseKeeper, LiteralKeeper>>
-{
-  using Symbol = typename Alphabet::Symbol;
-};
-
-class call {
-private:
-  std::string output;
-public:
-  call(std::string output) : output(output) { }
-
-  template <typename Index>
-  void invoke(Index &idx)
-  {
-    using Symbol = typename GetSymbol<Index>::Symbol;
-    const constexpr size_t buffer_length = 4194304;
-    std::array<Symbol, buffer_length> buffer;
-    const char *buf_ptr = reinterpret_cast<const char*>(buffer.data());
-
-    std::ofstream out(output, std::ios_base::binary);
-
-    auto idx_length = idx.size();
-    for (auto start = 0UL; start < idx_length; start += buffer_length) {
-      auto end = std::min<size_t>(start + buffer_length, idx_length);
-      idx(start, end, buffer.begin());
-      out.write(buf_ptr, sizeof(Symbol) * (end - start));
-    }
-  }
-};
+#include <any_index.hpp>
 
 int main(int argc, char **argv)
 {
@@ -87,8 +37,9 @@ int main(int argc, char **argv)
     string reference  = vm["reference-file"].as<string>();
     string output     = vm["output-file"].as<string>();
 
-    call c { output };
-    rlz::serialize::load_stream(index.c_str(), reference.c_str(), c);
+    auto idx = rlz::any_index::load(index.c_str(), reference.c_str());
+    std::ofstream out(output, std::ios_base::binary);
+    idx.decompress_range(0UL, idx.size(), out);
      
   } catch (std::exception &e) {
     std::cerr << e.what() << "\n"
@@ -1,42 +1,38 @@
+#include <algorithm>
 #include <cstdlib>
 #include <cstdint>
+#include <cstring>
+#include <iostream>
 #include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
-#include <api.hpp>
-#include <io.hpp>
-
-std::ostream &operator<<(std::ostream &s, const std::vector<char> &v)
-{
-  s << std::string(v.data(), v.size());
-  return s;
-}
+#include <any_index.hpp>
 
+// Prints raw symbols: as text when one byte wide, as space-separated integers otherwise.
 template <typename T>
-std::ostream &operator<<(std::ostream &s, const std::vector<T> &v)
+void print_symbols(const std::vector<char> &raw, std::ostream &s)
 {
-  for (auto i : v) {
-    s << i << " ";
+  for (auto i = 0UL; i < raw.size(); i += sizeof(T)) {
+    T v;
+    std::memcpy(&v, raw.data() + i, sizeof(T));
+    s << v << " ";
   }
-  return s;
 }
 
-class call {
-private:
-  size_t start;
-  size_t end;
-public:
-  call(size_t start, size_t end) : start(start), end(end) { }
-
-  template <typename Index>
-  void invoke(Index &idx)
-  {
-		start = std::min(start, idx.size());
-		end 	= std::min(end, idx.size());
-    std::cout << idx(start, end);
+void print_symbols(const std::vector<char> &raw, size_t symbol_bytes, std::ostream &s)
+{
+  switch (symbol_bytes) {
+    case 1:  s << std::string(raw.data(), raw.size()); break;
+    case 2:  print_symbols<std::uint16_t>(raw, s); break;
+    case 4:  print_symbols<std::uint32_t>(raw, s); break;
+    case 8:  print_symbols<std::uint64_t>(raw, s); break;
+    default: throw std::logic_error("Unsupported symbol width");
   }
-};
+}
 
 int main(int argc, char **argv)
 {
@@ -70,8 +66,10 @@ int main(int argc, char **argv)
     size_t start      = vm["start"].as<size_t>();
     size_t end        = vm["end"].as<size_t>();
 
-    call c { start, end };
-    rlz::serialize::load_stream(index.c_str(), reference.c_str(), c);
+    auto idx = rlz::any_index::load(index.c_str(), reference.c_str());
+    start    = std::min(start, idx.size());
+    end      = std::min(end, idx.size());
+    print_symbols(idx.extract(start, std::max(start, end)), idx.symbol_bytes(), std::cout);
      
   } catch (std::exception &e) {
     std::cerr << e.what() << "\n"
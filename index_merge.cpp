@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <sdsl/io.hpp>
+
+#include <api.hpp>
+#include <index_merge.hpp>
+
+// Merges the parts into the type of the first one; the reference is never read, as merging only
+// rewrites pointers into it. Every part must have been built against a reference of its length.
+class merge_parts {
+private:
+  std::vector<std::string> parts;
+  std::string output;
+
+public:
+  merge_parts(std::vector<std::string> parts, std::string output) : parts(parts), output(output) { }
+
+  template <typename Index>
+  void invoke(Index &first)
+  {
+    using namespace std::chrono;
+    auto t_1 = high_resolution_clock::now();
+    rlz::index_merger<Index> merger;
+    merger.append(first);
+    std::cout << "--- " << parts.front() << ": " << first.size() << " symbols" << std::endl;
+    for (auto it = std::next(parts.begin()); it != parts.end(); ++it) {
+      // With its source set first, the part is rejected if built against another reference
+      Index part;
+      part.set_source(first.get_source());
+      rlz::serialize::load_into(it->c_str(), part);
+      merger.append(part);
+      std::cout << "--- " << *it << ": " << part.size() << " symbols" << std::endl;
+    }
+    auto merged = merger.get();
+    auto t_2 = high_resolution_clock::now();
+    std::cout << "=== Merge time: " << duration_cast<milliseconds>(t_2 - t_1).count() << " ms\n"
+              << "--- Index size: " << sdsl::size_in_bytes(merged) << " bytes, "
+              << merged.size() << " symbols" << std::endl;
+    rlz::serialize::store(merged, output.c_str());
+  }
+};
+
+int main(int argc, char **argv)
+{
+  using std::string;
+  namespace po = boost::program_options;
+  po::options_description desc;
+  po::variables_map vm;
+  try {
+    desc.add_options()
+        ("reference-file,r", po::value<string>()->required(),
+         "Reference file, shared by all the parts.")
+        ("output-file,o", po::value<string>()->required(),
+         "Output file.")
+        ("index-file,i", po::value<std::vector<string>>()->required()->multitoken(),
+         "Index files of consecutive input segments, in input order.");
+
+    po::positional_options_description pd;
+    pd.add("reference-file", 1).add("output-file", 1).add("index-file", -1);
+
+    try {
+      po::store(po::command_line_parser(argc, argv).options(desc).positional(pd).run(), vm);
+      po::notify(vm);
+    } catch (boost::program_options::error &e) {
+      throw std::runtime_error(e.what());
+    }
+
+    string reference = vm["reference-file"].as<string>();
+    string output    = vm["output-file"].as<string>();
+    auto parts       = vm["index-file"].as<std::vector<string>>();
+
+    // The first part fixes the configuration; the reference stays on disk.
+    merge_parts merge(parts, output);
+    rlz::serialize::load_paged(parts.front().c_str(), reference.c_str(), 1UL << 20, merge);
+
+  } catch (std::exception &e) {
+    std::cerr << e.what() << "\n"
+              << "Command-line options:"  << "\n"
+              << desc << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
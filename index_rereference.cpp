@@ -0,0 +1,153 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include <boost/program_options.hpp>
+
+#include <sdsl/io.hpp>
+
+#include <alphabet.hpp>
+#include <api.hpp>
+#include <parse.hpp>
+#include <parse_rlzap.hpp>
+#include <rereference.hpp>
+
+template <typename Alphabet>
+struct symbol_bits {
+  static constexpr size_t value = 8UL * sizeof(typename Alphabet::Symbol);
+};
+
+template <typename BlockSize>
+struct symbol_bits<rlz::alphabet::dna<BlockSize>> {
+  static constexpr size_t value = 2UL;
+};
+
+template <typename Index>
+struct parse_keeper_of { };
+
+template <typename Alphabet, typename Source, typename ParseKeeper, typename LiteralKeeper>
+struct parse_keeper_of<rlz::index<Alphabet, Source, ParseKeeper, LiteralKeeper>> {
+  using Type = ParseKeeper;
+};
+
+// Parser for the reparsed regions: the automatic RLZAP parser with the pointer sizes of the index,
+// or the classic one with its defaults for classic indexes.
+template <typename Alphabet, typename ParseKeeper>
+rlz::parser_rlzap reparser(std::false_type)
+{
+  return rlz::parser_rlzap{ParseKeeper::delta_bits, ParseKeeper::ptr_size, symbol_bits<Alphabet>::value};
+}
+
+template <typename Alphabet, typename ParseKeeper>
+rlz::Parser reparser(std::true_type)
+{
+  return rlz::Parser{};
+}
+
+// Moves a loaded index onto the new reference.
+class rereference_index {
+private:
+  std::string new_reference;
+  std::string map_file;
+  std::string matcher_file;
+  std::string output;
+
+public:
+  rereference_index(std::string new_reference, std::string map_file, std::string matcher_file, std::string output)
+    : new_reference(new_reference), map_file(map_file), matcher_file(matcher_file), output(output) { }
+
+  template <typename Index>
+  void invoke(Index &idx)
+  {
+    using namespace std::chrono;
+    using Alphabet    = typename Index::AlphabetType;
+    using ParseKeeper = typename parse_keeper_of<Index>::Type;
+
+    std::ifstream map_stream(map_file);
+    if (!map_stream.good()) {
+      throw std::logic_error("Map file not readable");
+    }
+    auto map = rlz::reference_map::load(map_stream);
+
+    std::ifstream ref_stream(new_reference);
+    auto reference = rlz::impl::stream_factory{ref_stream}.template get<Alphabet>();
+
+    auto t_1 = high_resolution_clock::now();
+    rlz::reference_matcher<Alphabet> matcher;
+    std::ifstream matcher_in(matcher_file);
+    if (!matcher_file.empty() and matcher_in.good()) {
+      matcher.load(matcher_in);
+      std::cout << "--- Matcher loaded from " << matcher_file << std::endl;
+    } else {
+      matcher = rlz::reference_matcher<Alphabet>(reference.begin(), reference.end());
+      if (!matcher_file.empty()) {
+        std::ofstream matcher_out(matcher_file);
+        matcher.serialize(matcher_out);
+        std::cout << "--- Matcher stored in " << matcher_file << std::endl;
+      }
+    }
+    auto t_2 = high_resolution_clock::now();
+
+    auto parser = reparser<Alphabet, ParseKeeper>(std::integral_constant<bool, ParseKeeper::delta_bits == 0UL>{});
+    size_t reparsed = 0UL;
+    auto moved = rlz::rereference(idx, reference, map, matcher, parser, &reparsed);
+    auto t_3 = high_resolution_clock::now();
+
+    std::cout << "=== Matcher time: " << duration_cast<milliseconds>(t_2 - t_1).count() << " ms\n"
+              << "=== Rereference time: " << duration_cast<milliseconds>(t_3 - t_2).count() << " ms\n"
+              << "--- Mapped reference: " << map.mapped() << " of " << idx.get_source().size() << " symbols\n"
+              << "--- Reparsed input: " << reparsed << " of " << idx.size() << " symbols\n"
+              << "--- Index size: " << sdsl::size_in_bytes(idx) << " -> " << sdsl::size_in_bytes(moved) << " bytes"
+              << std::endl;
+    rlz::serialize::store(moved, output.c_str());
+  }
+};
+
+int main(int argc, char **argv)
+{
+  using std::string;
+  namespace po = boost::program_options;
+  po::options_description desc;
+  po::variables_map vm;
+  try {
+    desc.add_options()
+        ("index-file,i", po::value<string>()->required(),
+         "Index to move onto the new reference.")
+        ("reference-file,r", po::value<string>()->required(),
+         "Reference the index was built against.")
+        ("new-reference-file,n", po::value<string>()->required(),
+         "New version of the reference.")
+        ("map-file,m", po::value<string>()->required(),
+         "Blocks of the old reference found unchanged in the new one, as \"old_start new_start length\" lines.")
+        ("output-file,o", po::value<string>()->required(),
+         "Output file.")
+        ("matcher-file,M", po::value<string>()->default_value(""),
+         "Matcher of the new reference: loaded if the file exists, otherwise built and stored there.");
+
+    po::positional_options_description pd;
+    pd.add("index-file", 1).add("reference-file", 1).add("new-reference-file", 1).add("map-file", 1).add("output-file", 1);
+
+    try {
+      po::store(po::command_line_parser(argc, argv).options(desc).positional(pd).run(), vm);
+      po::notify(vm);
+    } catch (boost::program_options::error &e) {
+      throw std::runtime_error(e.what());
+    }
+
+    rereference_index call(
+      vm["new-reference-file"].as<string>(), vm["map-file"].as<string>(),
+      vm["matcher-file"].as<string>(), vm["output-file"].as<string>()
+    );
+    rlz::serialize::load_stream(vm["index-file"].as<string>().c_str(), vm["reference-file"].as<string>().c_str(), call);
+
+  } catch (std::exception &e) {
+    std::cerr << e.what() << "\n"
+              << "Command-line options:"  << "\n"
+              << desc << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
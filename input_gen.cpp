@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <sdsl/int_vector.hpp>
+
+#include <io.hpp>
+#include <sa_compute.hpp>
+
+struct rates {
+  double snp;         // Per-base probabilities of each event
+  double indel;
+  double sv;
+  double n_run;
+  size_t indel_len;   // Mean event lengths
+  size_t sv_len;
+  size_t n_len;
+};
+
+struct event_counts {
+  size_t snps, insertions, deletions, inversions, duplications, translocations, n_runs;
+};
+
+// Buffered output, truncated after limit symbols.
+class sink {
+  std::ofstream     out;
+  std::vector<char> buffer;
+  size_t            limit;
+  size_t            written;
+public:
+  sink(const std::string &name, size_t limit) : limit(limit), written(0UL)
+  {
+    rlz::io::open_file(out, name.c_str());
+    if (!out.good()) {
+      throw std::runtime_error("Cannot open " + name + " for writing");
+    }
+    buffer.reserve(1UL << 20);
+  }
+
+  bool full() const { return written >= limit; }
+
+  void put(char c)
+  {
+    if (not full()) {
+      buffer.push_back(c);
+      ++written;
+      if (buffer.size() == buffer.capacity()) { flush(); }
+    }
+  }
+
+  template <typename It>
+  void put(It begin, It end)
+  {
+    for (; begin != end and not full(); ++begin) {
+      put(*begin);
+    }
+  }
+
+  void flush()
+  {
+    rlz::io::write_file(out, buffer.data(), buffer.size());
+    buffer.clear();
+  }
+
+  ~sink() { flush(); }
+};
+
+char complement(char c)
+{
+  switch (c) {
+    case 'A': return 'T';
+    case 'C': return 'G';
+    case 'G': return 'C';
+    case 'T': return 'A';
+    default:  return c;
+  }
+}
+
+// Individuals of a population: each one is the reference with independent SNPs, short indels,
+// structural variants (inversions, tandem duplications, translocations) and runs of Ns.
+class mutator {
+  const std::vector<char>               &ref;
+  rates                                 r;
+  std::default_random_engine            &rg;
+  std::uniform_int_distribution<size_t> base;
+  std::uniform_int_distribution<size_t> position;
+  std::uniform_real_distribution<double> unif;
+
+  static constexpr char bases[] = { 'A', 'C', 'G', 'T' };
+
+  size_t length(size_t mean)
+  {
+    return 1UL + std::geometric_distribution<size_t>(1.0 / mean)(rg);
+  }
+
+public:
+  mutator(const std::vector<char> &ref, rates r, std::default_random_engine &rg)
+    : ref(ref), r(r), rg(rg), base(0UL, 3UL), position(0UL, ref.size() - 1), unif(0.0, 1.0) { }
+
+  void emit(sink &out, event_counts &c)
+  {
+    auto total = r.snp + r.indel + r.sv + r.n_run;
+    std::geometric_distribution<size_t> gap(total > 0.0 ? std::min(1.0, total) : 1.0);
+    auto p = 0UL;
+    while (p < ref.size() and not out.full()) {
+      // Copy up to the next event
+      auto next = total > 0.0 ? std::min(ref.size(), p + gap(rg)) : ref.size();
+      out.put(ref.begin() + p, ref.begin() + next);
+      p = next;
+      if (p == ref.size()) {
+        break;
+      }
+
+      auto e = unif(rg) * total;
+      if ((e -= r.snp) < 0.0) {
+        auto b = bases[base(rg)];
+        out.put(b != ref[p] ? b : bases[(std::find(bases, bases + 4, b) - bases + 1) % 4]);
+        ++p;
+        ++c.snps;
+      } else if ((e -= r.indel) < 0.0) {
+        auto len = length(r.indel_len);
+        if (unif(rg) < 0.5) {
+          for (auto i = 0UL; i < len; ++i) { out.put(bases[base(rg)]); }
+          ++c.insertions;
+        } else {
+          p = std::min(ref.size(), p + len);
+          ++c.deletions;
+        }
+      } else if ((e -= r.sv) < 0.0) {
+        auto len  = std::min(length(r.sv_len), ref.size() - p);
+        auto kind = unif(rg);
+        if (kind < 1.0 / 3) {
+          for (auto i = p + len; i > p; --i) { out.put(complement(ref[i - 1])); }
+          ++c.inversions;
+        } else if (kind < 2.0 / 3) {
+          out.put(ref.begin() + p, ref.begin() + p + len);
+          out.put(ref.begin() + p, ref.begin() + p + len);
+          ++c.duplications;
+        } else {
+          auto from = std::min(position(rg), ref.size() - len);
+          out.put(ref.begin() + from, ref.begin() + from + len);
+          ++c.translocations;
+        }
+        p += len;
+      } else {
+        auto len = std::min(length(r.n_len), ref.size() - p);
+        for (auto i = 0UL; i < len; ++i) { out.put('N'); }
+        p += len;
+        ++c.n_runs;
+      }
+    }
+  }
+};
+
+constexpr char mutator::bases[];
+
+std::vector<char> random_reference(size_t len, const rates &r, std::default_random_engine &rg)
+{
+  static const char bases[] = { 'A', 'C', 'G', 'T' };
+  std::uniform_int_distribution<size_t> base(0UL, 3UL);
+  std::bernoulli_distribution n_start(r.n_run);
+  std::geometric_distribution<size_t> n_len(1.0 / r.n_len);
+  std::vector<char> ref(len);
+  for (auto i = 0UL; i < len; ) {
+    if (n_start(rg)) {
+      auto end = std::min(len, i + 1UL + n_len(rg));
+      std::fill(ref.begin() + i, ref.begin() + end, 'N');
+      i = end;
+    } else {
+      ref[i++] = bases[base(rg)];
+    }
+  }
+  return ref;
+}
+
+// Sizes with an optional K, M or G (binary) suffix
+size_t parse_size(const std::string &s)
+{
+  size_t idx = 0UL;
+  auto val   = std::stod(s, &idx);
+  auto unit  = idx < s.size() ? std::toupper(s[idx]) : ' ';
+  switch (unit) {
+    case ' ': break;
+    case 'K': val *= 1UL << 10; break;
+    case 'M': val *= 1UL << 20; break;
+    case 'G': val *= 1UL << 30; break;
+    default:  throw std::runtime_error("Invalid size " + s);
+  }
+  return static_cast<size_t>(val);
+}
+
+// Differential LCP of the text stored in file_name (int32, one value per symbol)
+void write_dlcp(const std::string &file_name, const std::string &out_name)
+{
+  size_t len = 0UL;
+  auto text  = rlz::io::read_file<char>(file_name.c_str(), &len);
+  std::vector<char> T(text.get(), text.get() + len);
+  text.reset();
+  T.push_back('\0');    // Sentinel, as in get_matchings
+
+  sdsl::int_vector<> SA, LCP;
+  rlz::sa_compute<char>{}(T.data(), SA, LCP, T.size());
+
+  std::vector<std::int32_t> dlcp(len);
+  std::int64_t prev = 0;
+  for (auto i = 0UL; i < len; ++i) {
+    std::int64_t cur = LCP[i + 1];    // Skips the sentinel suffix
+    dlcp[i] = static_cast<std::int32_t>(cur - prev);
+    prev    = cur;
+  }
+  std::ofstream out;
+  rlz::io::open_file(out, out_name.c_str());
+  rlz::io::write_file(out, dlcp.data(), dlcp.size());
+}
+
+int main(int argc, char **argv)
+{
+  using std::string;
+  namespace po = boost::program_options;
+  po::options_description desc;
+  po::variables_map vm;
+  try {
+    desc.add_options()
+        ("output,o", po::value<string>()->required(),
+         "Generated input file.")
+        ("reference,r", po::value<string>(),
+         "Seed reference (default: a random one is generated).")
+        ("reference-output,R", po::value<string>(),
+         "Where to store the generated reference (default: <output>.ref).")
+        ("reference-size,L", po::value<string>()->default_value("16M"),
+         "Length of the generated reference (K, M and G suffixes allowed).")
+        ("size,n", po::value<string>()->default_value("256M"),
+         "Length of the generated input (K, M and G suffixes allowed).")
+        ("snp", po::value<double>()->default_value(0.001),
+         "Per-base SNP rate.")
+        ("indel", po::value<double>()->default_value(0.0001),
+         "Per-base rate of short insertions and deletions.")
+        ("indel-length", po::value<size_t>()->default_value(4UL),
+         "Mean indel length.")
+        ("sv", po::value<double>()->default_value(0.000001),
+         "Per-base rate of structural variants (inversions, duplications, translocations).")
+        ("sv-length", po::value<size_t>()->default_value(5000UL),
+         "Mean structural-variant length.")
+        ("n-run", po::value<double>()->default_value(0.000001),
+         "Per-base rate of N runs.")
+        ("n-length", po::value<size_t>()->default_value(1000UL),
+         "Mean N-run length.")
+        ("dlcp,d",
+         "Also write the DLCP sequences (int32) of the input and the reference, as <output>.dlcp and <output>.ref.dlcp.")
+        ("seed,s", po::value<size_t>()->default_value(42UL),
+         "Random seed.");
+
+    try {
+      po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+      po::notify(vm);
+    } catch (boost::program_options::error &e) {
+      throw std::runtime_error(e.what());
+    }
+
+    rates r {
+      vm["snp"].as<double>(), vm["indel"].as<double>(), vm["sv"].as<double>(), vm["n-run"].as<double>(),
+      vm["indel-length"].as<size_t>(), vm["sv-length"].as<size_t>(), vm["n-length"].as<size_t>()
+    };
+    for (auto rate : { r.snp, r.indel, r.sv, r.n_run }) {
+      if (rate < 0.0 or rate > 1.0) {
+        throw std::runtime_error("Rates must be in [0, 1]");
+      }
+    }
+    if (r.indel_len == 0UL or r.sv_len == 0UL or r.n_len == 0UL) {
+      throw std::runtime_error("Mean lengths must be positive");
+    }
+
+    string output = vm["output"].as<string>();
+    auto size     = parse_size(vm["size"].as<string>());
+    std::default_random_engine rg(vm["seed"].as<size_t>());
+
+    // Reference
+    std::vector<char> ref;
+    string ref_name;
+    if (vm.count("reference")) {
+      ref_name = vm["reference"].as<string>();
+      size_t len = 0UL;
+      auto data  = rlz::io::read_file<char>(ref_name.c_str(), &len);
+      ref.assign(data.get(), data.get() + len);
+    } else {
+      ref_name = vm.count("reference-output") ? vm["reference-output"].as<string>() : output + ".ref";
+      ref      = random_reference(parse_size(vm["reference-size"].as<string>()), r, rg);
+      sink out(ref_name, ref.size());
+      out.put(ref.begin(), ref.end());
+    }
+    if (ref.empty()) {
+      throw std::runtime_error("Empty reference");
+    }
+
+    // Input: individuals one after the other, until size symbols
+    event_counts c { 0UL, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL };
+    size_t individuals = 0UL;
+    {
+      sink out(output, size);
+      mutator m(ref, r, rg);
+      while (not out.full()) {
+        m.emit(out, c);
+        ++individuals;
+      }
+    }
+    std::cerr << "Reference        " << ref_name << " (" << ref.size() << " symbols)\n"
+              << "Input            " << output << " (" << size << " symbols)\n"
+              << "Individuals      " << individuals << "\n"
+              << "SNPs             " << c.snps << "\n"
+              << "Insertions       " << c.insertions << "\n"
+              << "Deletions        " << c.deletions << "\n"
+              << "Inversions       " << c.inversions << "\n"
+              << "Duplications     " << c.duplications << "\n"
+              << "Translocations   " << c.translocations << "\n"
+              << "N runs           " << c.n_runs << std::endl;
+
+    if (vm.count("dlcp")) {
+      write_dlcp(output, output + ".dlcp");
+      write_dlcp(ref_name, output + ".ref.dlcp");
+    }
+  } catch (std::exception &e) {
+    std::cerr << e.what() << "\n"
+              << "Command-line options:"  << "\n"
+              << desc << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+#include <any_index.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include <sdsl/io.hpp>
+
+#include <api.hpp>
+#include <type_name.hpp>
+
+namespace rlz {
+
+class any_index::handle {
+public:
+  virtual ~handle() { }
+
+  virtual size_t size() const = 0;
+  virtual size_t symbol_bytes() const = 0;
+  virtual std::string type_name() const = 0;
+  virtual size_t size_in_bytes() const = 0;
+  virtual void extract_batch(const range *ranges, size_t n, void *out) const = 0;
+  virtual void decompress_range(size_t begin, size_t end, std::ostream &out, size_t buffer_len) const = 0;
+  virtual void process_parsing(const phrase_visitor &f, size_t chunk_len) const = 0;
+};
+
+namespace {
+
+template <typename Index>
+class model : public any_index::handle {
+  using Symbol = typename Index::Symbol;
+  Index idx;
+public:
+  explicit model(Index &&idx) : idx(std::move(idx)) { }
+
+  size_t size() const override { return idx.size(); }
+
+  size_t symbol_bytes() const override { return sizeof(Symbol); }
+
+  std::string type_name() const override { return rlz::util::type_name(idx); }
+
+  size_t size_in_bytes() const override { return sdsl::size_in_bytes(idx); }
+
+  void extract_batch(const any_index::range *ranges, size_t n, void *out) const override
+  {
+    auto ptr = static_cast<Symbol*>(out);
+    for (auto i = 0UL; i < n; ++i) {
+      idx(ranges[i].first, ranges[i].second, ptr);
+      ptr += ranges[i].second - ranges[i].first;
+    }
+  }
+
+  void decompress_range(size_t begin, size_t end, std::ostream &out, size_t buffer_len) const override
+  {
+    std::vector<Symbol> buffer(std::min(end - begin, buffer_len));
+    const char *buf_ptr = reinterpret_cast<const char*>(buffer.data());
+    for (auto start = begin; start < end; start += buffer.size()) {
+      auto stop = std::min(start + buffer.size(), end);
+      idx(start, stop, buffer.begin());
+      out.write(buf_ptr, sizeof(Symbol) * (stop - start));
+    }
+  }
+
+  void process_parsing(const any_index::phrase_visitor &f, size_t chunk_len) const override
+  {
+    std::vector<any_index::phrase> chunk;
+    chunk.reserve(chunk_len);
+    auto collect = [&] (std::int64_t offset, size_t copy_len, size_t lit_len) {
+      chunk.push_back(any_index::phrase { offset, copy_len, lit_len });
+      if (chunk.size() == chunk_len) {
+        f(chunk.data(), chunk.size());
+        chunk.clear();
+      }
+    };
+    idx.process_parsing(collect);
+    if (!chunk.empty()) {
+      f(chunk.data(), chunk.size());
+    }
+  }
+};
+
+struct make_handle {
+  std::shared_ptr<const any_index::handle> result;
+
+  template <typename Index>
+  void invoke(Index &idx)
+  {
+    result = std::make_shared<model<Index>>(std::move(idx));
+  }
+};
+
+}
+
+any_index any_index::load(std::istream &index, std::istream &reference)
+{
+  make_handle c;
+  serialize::load_stream(index, reference, c);
+  return any_index(std::move(c.result));
+}
+
+// Loads the sections of the index concurrently, each one from its own stream over index_file
+any_index any_index::load(const char *index_file, const char *reference_file)
+{
+  if (!std::ifstream(reference_file, std::ios_base::binary).good()) {
+    throw std::logic_error("Reference file not readable");
+  }
+  make_handle c;
+  serialize::load_stream(index_file, reference_file, c);
+  return any_index(std::move(c.result));
+}
+
+const any_index::handle &any_index::get() const
+{
+  if (!impl) {
+    throw std::logic_error("No index loaded");
+  }
+  return *impl;
+}
+
+void any_index::check_range(size_t begin, size_t end) const
+{
+  if (begin > end or end > get().size()) {
+    throw std::logic_error(
+      "Range [" + std::to_string(begin) + ", " + std::to_string(end) + ") out of index bounds"
+    );
+  }
+}
+
+size_t any_index::size() const { return get().size(); }
+
+size_t any_index::symbol_bytes() const { return get().symbol_bytes(); }
+
+std::string any_index::type_name() const { return get().type_name(); }
+
+size_t any_index::size_in_bytes() const { return get().size_in_bytes(); }
+
+void any_index::extract(size_t begin, size_t end, void *out) const
+{
+  range r { begin, end };
+  extract_batch(&r, 1UL, out);
+}
+
+std::vector<char> any_index::extract(size_t begin, size_t end) const
+{
+  check_range(begin, end);
+  // Allocate whole 64-bit words, so that the buffer is aligned for every symbol width
+  auto bytes = (end - begin) * symbol_bytes();
+  std::vector<std::uint64_t> buffer((bytes + 7UL) / 8UL);
+  extract(begin, end, buffer.data());
+  auto ptr = reinterpret_cast<const char*>(buffer.data());
+  return std::vector<char>(ptr, ptr + bytes);
+}
+
+void any_index::extract_batch(const range *ranges, size_t n, void *out) const
+{
+  for (auto i = 0UL; i < n; ++i) {
+    check_range(ranges[i].first, ranges[i].second);
+  }
+  get().extract_batch(ranges, n, out);
+}
+
+void any_index::extract_batch(const std::vector<range> &ranges, void *out) const
+{
+  extract_batch(ranges.data(), ranges.size(), out);
+}
+
+void any_index::decompress_range(size_t begin, size_t end, std::ostream &out, size_t buffer_len) const
+{
+  check_range(begin, end);
+  if (buffer_len == 0UL) {
+    throw std::logic_error("Decompression buffer must be non-empty");
+  }
+  get().decompress_range(begin, end, out, buffer_len);
+}
+
+void any_index::process_parsing(const phrase_visitor &f, size_t chunk_len) const
+{
+  if (chunk_len == 0UL) {
+    throw std::logic_error("Parsing chunks must be non-empty");
+  }
+  get().process_parsing(f, chunk_len);
+}
+
+}
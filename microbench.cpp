@@ -0,0 +1,470 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options.hpp>
+
+#include <alphabet.hpp>
+#include <bit_vectors.hpp>
+#include <build_coordinator.hpp>
+#include <dna_packer.hpp>
+#include <parse_keeper.hpp>
+#include <prefix_sum.hpp>
+#include <sparse_dense_vector.hpp>
+#include <sdsl_extensions/lcp_byte.hpp>
+
+struct settings {
+  size_t                    elements;
+  size_t                    queries;
+  size_t                    seed;
+  std::vector<double>       densities;
+  std::vector<std::string>  groups;       // Structures to time (empty: all of them)
+};
+
+// A timed operation. Every result carries the same fields (schema version 1): new parameters go
+// in params, so consumers keyed on (benchmark, structure, params) keep working.
+struct result {
+  std::string                                  benchmark;   // Operation, e.g. "rank_1"
+  std::string                                  structure;   // Structure, e.g. "BitVector<sparse>"
+  std::vector<std::pair<std::string, double>>  params;      // Workload and template parameters
+  size_t                                       elements;    // Structure length
+  size_t                                       ops;         // Timed operations
+  double                                       ns_per_op;
+  size_t                                       bytes;       // Structure size
+};
+
+class report {
+  settings            s;
+  std::vector<result> results;
+public:
+  size_t              checksum;     // Sink for the timed results
+
+  report(settings s) : s(s), checksum(0UL) { }
+
+  const settings &config() const { return s; }
+
+  bool enabled(const std::string &group) const
+  {
+    return s.groups.empty() or std::find(s.groups.begin(), s.groups.end(), group) != s.groups.end();
+  }
+
+  void add(result r) { results.push_back(std::move(r)); }
+
+  void write_json(std::ostream &out) const
+  {
+    out << std::fixed << std::setprecision(3);
+    out << "{\n"
+        << "  \"schema_version\": 1,\n"
+        << "  \"elements\": " << s.elements << ",\n"
+        << "  \"queries\": " << s.queries << ",\n"
+        << "  \"seed\": " << s.seed << ",\n"
+        << "  \"results\": [";
+    for (auto i = 0UL; i < results.size(); ++i) {
+      auto &r = results[i];
+      out << (i > 0 ? ",\n" : "\n")
+          << "    { \"benchmark\": \"" << r.benchmark << "\", \"structure\": \"" << r.structure << "\", \"params\": {";
+      for (auto j = 0UL; j < r.params.size(); ++j) {
+        out << (j > 0 ? ", " : " ") << "\"" << r.params[j].first << "\": " << std::defaultfloat << std::setprecision(10) << r.params[j].second
+            << std::fixed << std::setprecision(3);
+      }
+      out << (r.params.empty() ? "}" : " }")
+          << ", \"elements\": " << r.elements << ", \"ops\": " << r.ops
+          << ", \"ns_per_op\": " << r.ns_per_op << ", \"bytes\": " << r.bytes << " }";
+    }
+    out << "\n  ]\n}" << std::endl;
+  }
+
+  void write_table(std::ostream &out) const
+  {
+    out << std::left << std::setw(18) << "Benchmark" << std::setw(28) << "Structure" << std::setw(30) << "Parameters"
+        << std::right << std::setw(12) << "ns/op" << std::setw(14) << "Bytes" << "\n";
+    for (auto &r : results) {
+      std::string params;
+      for (auto &p : r.params) {
+        std::ostringstream v;
+        v << p.second;
+        params += (params.empty() ? "" : " ") + p.first + "=" + v.str();
+      }
+      out << std::left << std::setw(18) << r.benchmark << std::setw(28) << r.structure << std::setw(30) << params
+          << std::right << std::setw(12) << std::fixed << std::setprecision(2) << r.ns_per_op
+          << std::setw(14) << r.bytes << "\n";
+    }
+    out << std::defaultfloat << std::flush;
+  }
+};
+
+template <typename Cumulative, typename Fun>
+double time_queries(const Cumulative &cum, const std::vector<size_t> &queries, Fun f, size_t &checksum)
+{
+  using namespace std::chrono;
+  auto t_1 = high_resolution_clock::now();
+  for (auto q : queries) {
+    checksum += f(cum, q);
+  }
+  auto t_2 = high_resolution_clock::now();
+  return 1.0 * duration_cast<nanoseconds>(t_2 - t_1).count() / queries.size();
+}
+
+std::vector<size_t> random_queries(size_t low, size_t high, size_t n, std::default_random_engine &rg)
+{
+  std::uniform_int_distribution<size_t> dist(low, high);
+  std::vector<size_t> queries(n);
+  for (auto &q : queries) { q = dist(rg); }
+  return queries;
+}
+
+// Set positions of a random bit-vector of the given length and density
+std::vector<size_t> random_ones(size_t length, double density, std::default_random_engine &rg)
+{
+  std::bernoulli_distribution bd(density);
+  std::vector<size_t> ones;
+  for (auto i = 0UL; i < length; ++i) {
+    if (bd(rg)) { ones.push_back(i); }
+  }
+  return ones;
+}
+
+/*
+ * Bit-vectors of the parse (rank_1 on phrase starts, select_1 on subphrase starts)
+ */
+template <typename Rep>
+void bit_vector_bench(report &r, const std::string &name, const std::vector<size_t> &ones, double density)
+{
+  using Bv = rlz::vectors::BitVector<Rep, rlz::vectors::algorithms::rank, rlz::vectors::algorithms::select>;
+  auto &s = r.config();
+  Bv bv(ones.begin(), ones.end(), s.elements);
+
+  std::default_random_engine rg(s.seed);
+  auto rank_q   = random_queries(0UL, s.elements - 1, s.queries, rg);
+  auto select_q = random_queries(1UL, ones.size(), s.queries, rg);
+  auto rank_ns   = time_queries(bv, rank_q,   [] (const Bv &b, size_t i) { return b.rank_1(i); },   r.checksum);
+  auto select_ns = time_queries(bv, select_q, [] (const Bv &b, size_t i) { return b.select_1(i); }, r.checksum);
+
+  auto bytes = sdsl::size_in_bytes(bv);
+  r.add(result { "rank_1",   "BitVector<" + name + ">", { { "density", density } }, s.elements, s.queries, rank_ns,   bytes });
+  r.add(result { "select_1", "BitVector<" + name + ">", { { "density", density } }, s.elements, s.queries, select_ns, bytes });
+}
+
+void bit_vector_benches(report &r)
+{
+  auto &s = r.config();
+  for (auto density : s.densities) {
+    std::default_random_engine rg(s.seed);
+    auto ones = random_ones(s.elements, density, rg);
+    if (ones.empty()) { continue; }
+    bit_vector_bench<rlz::vectors::sparse>(r, "sparse", ones, density);
+    bit_vector_bench<rlz::vectors::dense>(r, "dense", ones, density);
+    bit_vector_bench<rlz::vectors::interleaved>(r, "interleaved", ones, density);
+  }
+}
+
+/*
+ * Literal-length prefix sums
+ */
+template <size_t LengthWidth>
+std::vector<size_t> random_lengths(const settings &s)
+{
+  std::default_random_engine rg(s.seed);
+  return random_queries(0UL, (1UL << LengthWidth) - 1, s.elements, rg);
+}
+
+template <size_t LengthWidth, size_t SampleInterval>
+void sampling_bench(report &r)
+{
+  using Cumulative = rlz::prefix::sampling_cumulative<rlz::values::Size<LengthWidth>, rlz::values::Size<SampleInterval>>;
+  auto &s = r.config();
+  auto lengths = random_lengths<LengthWidth>(s);
+  Cumulative cum(lengths.begin(), lengths.end());
+
+  std::default_random_engine rg(s.seed);
+  auto queries = random_queries(0UL, s.elements - 1, s.queries, rg);
+  size_t check_word = 0U, check_table = 0U;
+  auto word  = time_queries(cum, queries, [] (const Cumulative &c, size_t i) { return c.prefix(i); }, check_word);
+  auto table = time_queries(cum, queries, [] (const Cumulative &c, size_t i) { return c.prefix_bytewise(i); }, check_table);
+  if (check_word != check_table) {
+    throw std::logic_error("Prefix kernels disagree");
+  }
+  r.checksum += check_word;
+
+  auto bytes = sdsl::size_in_bytes(cum);
+  std::vector<std::pair<std::string, double>> params { { "width", LengthWidth }, { "interval", SampleInterval } };
+  r.add(result { "prefix",          "sampling_cumulative", params, s.elements, s.queries, word,  bytes });
+  r.add(result { "prefix_bytewise", "sampling_cumulative", params, s.elements, s.queries, table, bytes });
+}
+
+template <size_t LengthWidth>
+void sampling_benches(report &r)
+{
+  sampling_bench<LengthWidth, 16U>(r);
+  sampling_bench<LengthWidth, 32U>(r);
+  sampling_bench<LengthWidth, 48U>(r);
+  sampling_bench<LengthWidth, 64U>(r);
+  sampling_bench<LengthWidth, 128U>(r);
+}
+
+template <typename Rep, size_t LengthWidth>
+void fast_bench(report &r, const std::string &name)
+{
+  using Cumulative = rlz::prefix::fast_cumulative<Rep, rlz::values::Size<LengthWidth>>;
+  auto &s = r.config();
+  auto lengths = random_lengths<LengthWidth>(s);
+  Cumulative cum(lengths.begin(), lengths.end());
+
+  std::default_random_engine rg(s.seed);
+  auto queries = random_queries(0UL, s.elements - 1, s.queries, rg);
+  auto ns = time_queries(cum, queries, [] (const Cumulative &c, size_t i) { return c.prefix(i); }, r.checksum);
+  r.add(result {
+    "prefix", "fast_cumulative<" + name + ">", { { "width", LengthWidth } }, s.elements, s.queries, ns, sdsl::size_in_bytes(cum)
+  });
+}
+
+template <size_t LengthWidth>
+void fast_benches(report &r)
+{
+  fast_bench<rlz::vectors::sparse, LengthWidth>(r, "sparse");
+  fast_bench<rlz::vectors::dense, LengthWidth>(r, "dense");
+  fast_bench<rlz::vectors::interleaved, LengthWidth>(r, "interleaved");
+}
+
+/*
+ * Literal containers: N markers, packed DNA and byte-compressed LCP values
+ */
+template <size_t ChunkSize>
+void sd_bitvector_bench(report &r, const std::vector<size_t> &ones, double density)
+{
+  using Bv = rlz::vectors::sd_bitvector<rlz::values::Size<ChunkSize>>;
+  auto &s = r.config();
+  Bv bv(ones.begin(), ones.end(), s.elements);
+
+  std::default_random_engine rg(s.seed);
+  auto queries = random_queries(0UL, s.elements - 1, s.queries, rg);
+  auto ns = time_queries(bv, queries, [] (const Bv &b, size_t i) { return *b.from(i); }, r.checksum);
+  r.add(result {
+    "from", "sd_bitvector", { { "chunk", ChunkSize }, { "density", density } }, s.elements, s.queries, ns, sdsl::size_in_bytes(bv)
+  });
+}
+
+void dna_pack_bench(report &r, double n_density)
+{
+  using Pack = rlz::dna_pack<>;
+  auto &s = r.config();
+  std::default_random_engine rg(s.seed);
+  std::uniform_int_distribution<size_t> base(0U, 3U);
+  std::bernoulli_distribution is_n(n_density);
+  const char bases[] = { 'A', 'C', 'G', 'T' };
+  std::vector<char> dna(s.elements);
+  for (auto &c : dna) { c = is_n(rg) ? 'N' : bases[base(rg)]; }
+  Pack pack(dna.begin(), dna.end());
+
+  auto queries = random_queries(0UL, s.elements - 1, s.queries, rg);
+  auto ns = time_queries(pack, queries, [] (const Pack &p, size_t i) { return static_cast<size_t>(*p.from(i)); }, r.checksum);
+  r.add(result { "from", "dna_pack", { { "n_density", n_density } }, s.elements, s.queries, ns, sdsl::size_in_bytes(pack) });
+}
+
+// Values outside the byte range occur with probability big_density
+template <typename Symbol>
+void lcp_byte_bench(report &r, const std::string &name, double big_density)
+{
+  using Lcp = sdsl::extensions::signed_lcp_byte<Symbol>;
+  auto &s = r.config();
+  std::default_random_engine rg(s.seed);
+  std::bernoulli_distribution is_big(big_density);
+  std::uniform_int_distribution<std::int64_t> small(std::is_signed<Symbol>::value ? -128 : 0, std::is_signed<Symbol>::value ? 126 : 254);
+  std::uniform_int_distribution<std::int64_t> big(1000, 1000000);
+  std::vector<Symbol> values(s.elements);
+  for (auto &v : values) { v = static_cast<Symbol>(is_big(rg) ? big(rg) : small(rg)); }
+  Lcp lcp(values.begin(), values.end());
+
+  auto queries = random_queries(0UL, s.elements - 1, s.queries, rg);
+  auto ns = time_queries(lcp, queries, [] (const Lcp &l, size_t i) { return static_cast<size_t>(l[i]); }, r.checksum);
+  r.add(result {
+    "access", "signed_lcp_byte<" + name + ">", { { "big_density", big_density } }, s.elements, s.queries, ns, sdsl::size_in_bytes(lcp)
+  });
+}
+
+/*
+ * Parse traversal
+ */
+// Pointers drift by a few positions between phrases (variants) and jump with probability
+// 1 / 32 (rearrangements); every copy is followed by a single mismatching literal.
+template <typename ParseKeeper>
+ParseKeeper random_parse(const settings &s, size_t mean_len)
+{
+  using Alphabet = rlz::alphabet::dna<>;
+  using SymbolIt = const char*;
+  using Builder  = typename ParseKeeper::template builder<SymbolIt>;
+
+  std::vector<char> text(s.elements, 'A');
+  auto builder = std::make_shared<Builder>();
+  std::vector<std::shared_ptr<rlz::build::observer<Alphabet, SymbolIt>>> obs { builder };
+  rlz::build::coordinator<Alphabet, SymbolIt> c(obs.begin(), obs.end(), text.data());
+
+  std::default_random_engine rg(s.seed);
+  std::geometric_distribution<size_t> len_dist(1.0 / mean_len);
+  std::uniform_int_distribution<std::int64_t> drift(-2, 2);
+  std::uniform_int_distribution<std::int64_t> jump(0, s.elements - 1);
+  std::bernoulli_distribution is_jump(1.0 / 32);
+  std::int64_t delta = 0;
+  for (auto pos = 0UL; pos < s.elements; ) {
+    auto len = std::min<size_t>(1UL + len_dist(rg), s.elements - pos);
+    delta    = is_jump(rg) ? jump(rg) - static_cast<std::int64_t>(pos) : delta + drift(rg);
+    auto src = std::min<std::int64_t>(std::max<std::int64_t>(0, pos + delta), s.elements - len);
+    c.copy_evt(pos, src, len);
+    pos += len;
+    if (pos < s.elements) {
+      c.literal_evt(pos, 1UL);
+      ++pos;
+    }
+  }
+  c.end_evt();
+  return builder->get();
+}
+
+template <typename SubphraseRep>
+void parse_keeper_bench(report &r, const std::string &name, size_t mean_len)
+{
+  using ParseKeeper = rlz::parse_keeper<rlz::alphabet::dna<>, rlz::values::Size<32UL>, rlz::values::Size<8UL>, rlz::vectors::dense, SubphraseRep>;
+  auto &s = r.config();
+  auto pk = random_parse<ParseKeeper>(s, mean_len);
+
+  // Full traversals, until at least s.queries increments
+  using namespace std::chrono;
+  size_t ops = 0UL;
+  auto t_1 = high_resolution_clock::now();
+  while (ops < s.queries) {
+    auto end = pk.get_iterator_end();
+    for (auto it = pk.get_iterator_begin(); it != end; ++it) {
+      auto ph = *it;
+      r.checksum += std::get<0>(ph) + std::get<1>(ph) + std::get<2>(ph);
+      ++ops;
+    }
+  }
+  auto t_2 = high_resolution_clock::now();
+  auto ns  = 1.0 * duration_cast<nanoseconds>(t_2 - t_1).count() / std::max<size_t>(1UL, ops);
+  r.add(result {
+    "increment", "parse_keeper<" + name + ">", { { "mean_phrase", mean_len } }, s.elements, ops, ns, sdsl::size_in_bytes(pk)
+  });
+}
+
+int main(int argc, char **argv)
+{
+  using std::string;
+  namespace po = boost::program_options;
+  po::options_description desc;
+  po::variables_map vm;
+  try {
+    desc.add_options()
+        ("elements,n", po::value<size_t>()->default_value(1UL << 24),
+         "Number of elements in each structure.")
+        ("queries,q", po::value<size_t>()->default_value(1UL << 22),
+         "Number of random queries.")
+        ("densities,d", po::value<string>()->default_value("0.001,0.01,0.1,0.5"),
+         "Comma-separated densities of set bits, Ns and large LCP values.")
+        ("only,b", po::value<string>(),
+         "Comma-separated structures to time (bit_vector, sampling_cumulative, fast_cumulative, "
+         "sd_bitvector, dna_pack, signed_lcp_byte, parse_keeper; default: all).")
+        ("format,f", po::value<string>()->default_value("json"),
+         "Output format (json or table).")
+        ("output,o", po::value<string>(),
+         "Output file (default: standard output).")
+        ("seed,s", po::value<size_t>()->default_value(42UL),
+         "Random seed.");
+
+    try {
+      po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+      po::notify(vm);
+    } catch (boost::program_options::error &e) {
+      throw std::runtime_error(e.what());
+    }
+
+    settings s { vm["elements"].as<size_t>(), vm["queries"].as<size_t>(), vm["seed"].as<size_t>(), { }, { } };
+    if (s.elements == 0U or s.queries == 0U) {
+      throw std::runtime_error("Number of elements and queries must be positive");
+    }
+    std::vector<string> densities;
+    boost::split(densities, vm["densities"].as<string>(), boost::is_any_of(","), boost::token_compress_on);
+    for (auto &d : densities) {
+      s.densities.push_back(std::stod(d));
+      if (s.densities.back() <= 0.0 or s.densities.back() > 1.0) {
+        throw std::runtime_error("Densities must be in (0, 1]");
+      }
+    }
+    if (vm.count("only")) {
+      boost::split(s.groups, vm["only"].as<string>(), boost::is_any_of(","), boost::token_compress_on);
+    }
+    auto format = vm["format"].as<string>();
+    if (format != "json" and format != "table") {
+      throw std::runtime_error("Unknown format " + format);
+    }
+
+    report r { s };
+    if (r.enabled("bit_vector")) {
+      bit_vector_benches(r);
+    }
+    if (r.enabled("sampling_cumulative")) {
+      sampling_benches<2U>(r);
+      sampling_benches<4U>(r);
+      sampling_benches<8U>(r);
+    }
+    if (r.enabled("fast_cumulative")) {
+      fast_benches<4U>(r);
+      fast_benches<8U>(r);
+    }
+    if (r.enabled("sd_bitvector")) {
+      for (auto density : s.densities) {
+        std::default_random_engine rg(s.seed);
+        auto ones = random_ones(s.elements, density, rg);
+        sd_bitvector_bench<8U>(r, ones, density);
+        sd_bitvector_bench<32U>(r, ones, density);
+      }
+    }
+    if (r.enabled("dna_pack")) {
+      for (auto density : s.densities) {
+        dna_pack_bench(r, density);
+      }
+    }
+    if (r.enabled("signed_lcp_byte")) {
+      for (auto density : s.densities) {
+        lcp_byte_bench<std::int32_t>(r, "int32", density);
+        lcp_byte_bench<std::uint32_t>(r, "uint32", density);
+      }
+    }
+    if (r.enabled("parse_keeper")) {
+      for (auto mean_len : { 16UL, 256UL }) {
+        parse_keeper_bench<rlz::vectors::sparse>(r, "sparse", mean_len);
+        parse_keeper_bench<rlz::vectors::dense>(r, "dense", mean_len);
+      }
+    }
+
+    std::ofstream file;
+    if (vm.count("output")) {
+      file.open(vm["output"].as<string>());
+    }
+    std::ostream &out = vm.count("output") ? file : std::cout;
+    if (format == "json") {
+      r.write_json(out);
+    } else {
+      r.write_table(out);
+    }
+    std::cerr << "Checksum: " << r.checksum << std::endl;
+  } catch (std::exception &e) {
+    std::cerr << e.what() << "\n"
+              << "Command-line options:"  << "\n"
+              << desc << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
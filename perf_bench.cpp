@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options.hpp>
+
+#include <sdsl/io.hpp>
+
+#include <api.hpp>
+#include <perf_counters.hpp>
+#include <zipf_gen.hpp>
+
+#define GCC_TURN_OFF_DEAD_STORE_OPT(x) __asm__ volatile("" : "+g"(x));
+
+struct settings {
+  std::vector<std::string> workloads;
+  std::vector<size_t>      lengths;
+  size_t                   queries;
+  size_t                   warmup;
+  size_t                   regions;     // Zipfian: distinct regions
+  double                   skew;        // Zipfian: exponent
+  size_t                   clusters;    // Clustered: number of hot spots
+  size_t                   spread;      // Clustered: symbols around each hot spot
+  size_t                   seed;
+  bool                     symbols;     // Also time single-symbol access
+};
+
+// Query starts in [0, max_start] for the given workload; sequential queries are adjacent ranges.
+std::vector<size_t> workload_starts(const std::string &w, size_t max_start, size_t length, const settings &s)
+{
+  std::default_random_engine rg(s.seed);
+  std::uniform_int_distribution<size_t> pos(0UL, max_start);
+  std::vector<size_t> starts(s.queries + s.warmup);
+  if (w == "uniform") {
+    for (auto &st : starts) { st = pos(rg); }
+  } else if (w == "sequential") {
+    auto cur = pos(rg);
+    for (auto &st : starts) {
+      st  = cur;
+      cur = cur + length <= max_start ? cur + length : 0UL;
+    }
+  } else if (w == "zipfian") {
+    std::vector<size_t> regions(s.regions);
+    for (auto &r : regions) { r = pos(rg); }
+    rlz::perf::zipf_gen zipf(s.regions, s.skew);
+    for (auto &st : starts) { st = regions[zipf(rg)]; }
+  } else if (w == "clustered") {
+    std::vector<size_t> centers(s.clusters);
+    for (auto &c : centers) { c = pos(rg); }
+    std::uniform_int_distribution<size_t> pick(0UL, s.clusters - 1);
+    std::uniform_int_distribution<size_t> around(0UL, 2 * s.spread);
+    for (auto &st : starts) {
+      auto c = centers[pick(rg)] + around(rg);
+      st = std::min(max_start, c > s.spread ? c - s.spread : 0UL);
+    }
+  } else {
+    throw std::runtime_error("Unknown workload " + w);
+  }
+  return starts;
+}
+
+struct result {
+  std::string                             workload;
+  std::string                             access;
+  size_t                                  length;
+  rlz::perf::summary                      latency;
+  std::vector<rlz::perf::counters::value> counts;
+};
+
+class call {
+  settings            s;
+  std::vector<result> results;
+  size_t              text_len;
+  size_t              index_bytes;
+  bool                counters_available;
+
+  // Times every query on its own; counters cover the whole timed batch.
+  template <typename Query>
+  result run(const std::string &w, const std::string &access, size_t length, const std::vector<size_t> &starts, Query q)
+  {
+    using clock = std::chrono::steady_clock;
+    for (auto i = 0UL; i < s.warmup; ++i) {
+      q(starts[i]);
+    }
+    std::vector<double> ns(s.queries);
+    rlz::perf::counters pc;
+    counters_available = pc.available();
+    pc.start();
+    for (auto i = 0UL; i < s.queries; ++i) {
+      auto t_1 = clock::now();
+      q(starts[s.warmup + i]);
+      auto t_2 = clock::now();
+      ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(t_2 - t_1).count();
+    }
+    pc.stop();
+    return result { w, access, length, rlz::perf::summary(std::move(ns)), pc.values() };
+  }
+
+public:
+  call(settings s) : s(s), text_len(0UL), index_bytes(0UL), counters_available(false) { }
+
+  template <typename Index>
+  void invoke(Index &idx)
+  {
+    using Symbol = typename Index::Symbol;
+    text_len    = idx.size();
+    index_bytes = sdsl::size_in_bytes(idx);
+    auto max_len = *std::max_element(s.lengths.begin(), s.lengths.end());
+    if (text_len <= max_len) {
+      throw std::logic_error("Range length exceeds index length");
+    }
+
+    std::vector<Symbol> buffer(max_len);
+    for (auto &w : s.workloads) {
+      for (auto len : s.lengths) {
+        auto starts = workload_starts(w, text_len - len, len, s);
+        results.push_back(run(w, "range", len, starts, [&] (size_t b) {
+          auto out = buffer.data();
+          idx(b, b + len, out);
+          GCC_TURN_OFF_DEAD_STORE_OPT(out);
+        }));
+      }
+      if (s.symbols) {
+        auto starts = workload_starts(w, text_len - 1, 1UL, s);
+        results.push_back(run(w, "symbol", 1UL, starts, [&] (size_t p) {
+          auto sym = idx(p);
+          GCC_TURN_OFF_DEAD_STORE_OPT(sym);
+        }));
+      }
+    }
+  }
+
+  void write_json(std::ostream &out, const std::string &index, const std::string &reference) const
+  {
+    out << std::fixed << std::setprecision(2);
+    out << "{\n"
+        << "  \"index\": \"" << index << "\",\n"
+        << "  \"reference\": \"" << reference << "\",\n"
+        << "  \"length\": " << text_len << ",\n"
+        << "  \"index_bytes\": " << index_bytes << ",\n"
+        << "  \"queries\": " << s.queries << ",\n"
+        << "  \"counters\": " << (counters_available ? "true" : "false") << ",\n"
+        << "  \"results\": [";
+    for (auto i = 0UL; i < results.size(); ++i) {
+      auto &r = results[i];
+      out << (i > 0 ? ",\n" : "\n")
+          << "    { \"workload\": \"" << r.workload << "\", \"access\": \"" << r.access << "\", "
+          << "\"range_length\": " << r.length << ",\n"
+          << "      \"mean_ns\": " << r.latency.mean << ", \"min_ns\": " << r.latency.min << ", ";
+      for (auto &p : r.latency.percentiles) {
+        std::ostringstream key;
+        key << "p" << p.first;
+        out << "\"" << boost::replace_all_copy(key.str(), ".", "_") << "_ns\": " << p.second << ", ";
+      }
+      out << "\"max_ns\": " << r.latency.max << ", "
+          << "\"ns_per_symbol\": " << r.latency.mean / r.length;
+      for (auto &c : r.counts) {
+        out << ", \"" << c.name << "_per_query\": " << 1.0 * c.count / std::max<size_t>(1UL, s.queries);
+      }
+      out << " }";
+    }
+    out << "\n  ]\n}" << std::endl;
+  }
+};
+
+int main(int argc, char **argv)
+{
+  using std::string;
+  namespace po = boost::program_options;
+  po::options_description desc;
+  po::variables_map vm;
+  try {
+    desc.add_options()
+        ("index-file,i", po::value<string>()->required(),
+         "Index filename.")
+        ("reference-file,r", po::value<string>()->required(),
+         "Reference file.")
+        ("workloads,w", po::value<string>()->default_value("uniform,sequential,zipfian,clustered"),
+         "Comma-separated workloads (uniform, sequential, zipfian, clustered).")
+        ("lengths,l", po::value<string>()->default_value("1,16,256,4096"),
+         "Comma-separated range lengths.")
+        ("times,t", po::value<size_t>()->default_value(100000UL),
+         "Timed queries per workload and length.")
+        ("warmup,W", po::value<size_t>()->default_value(1000UL),
+         "Untimed queries before each run.")
+        ("regions,n", po::value<size_t>()->default_value(10000UL),
+         "Zipfian: number of distinct regions.")
+        ("skew,z", po::value<double>()->default_value(1.0),
+         "Zipfian: exponent of region popularity.")
+        ("clusters,c", po::value<size_t>()->default_value(16UL),
+         "Clustered: number of hot spots.")
+        ("spread,d", po::value<size_t>()->default_value(65536UL),
+         "Clustered: symbols on each side of a hot spot.")
+        ("seed,s", po::value<size_t>()->default_value(42UL),
+         "Random seed.")
+        ("symbols,a",
+         "Also time single-symbol access.")
+        ("output,o", po::value<string>(),
+         "JSON output file (default: standard output).");
+
+    po::positional_options_description pd;
+    pd.add("index-file", 1).add("reference-file", 1);
+
+    try {
+      po::store(po::command_line_parser(argc, argv).options(desc).positional(pd).run(), vm);
+      po::notify(vm);
+    } catch (boost::program_options::error &e) {
+      throw std::runtime_error(e.what());
+    }
+
+    settings s;
+    boost::split(s.workloads, vm["workloads"].as<string>(), boost::is_any_of(","), boost::token_compress_on);
+    std::vector<string> lengths;
+    boost::split(lengths, vm["lengths"].as<string>(), boost::is_any_of(","), boost::token_compress_on);
+    for (auto &l : lengths) {
+      s.lengths.push_back(std::stoul(l));
+    }
+    s.queries  = vm["times"].as<size_t>();
+    s.warmup   = vm["warmup"].as<size_t>();
+    s.regions  = vm["regions"].as<size_t>();
+    s.skew     = vm["skew"].as<double>();
+    s.clusters = vm["clusters"].as<size_t>();
+    s.spread   = vm["spread"].as<size_t>();
+    s.seed     = vm["seed"].as<size_t>();
+    s.symbols  = vm.count("symbols") > 0;
+    if (s.queries == 0UL or s.regions == 0UL or s.clusters == 0UL) {
+      throw std::runtime_error("Queries, regions and clusters must be positive");
+    }
+    if (std::find(s.lengths.begin(), s.lengths.end(), 0UL) != s.lengths.end()) {
+      throw std::runtime_error("Range lengths must be positive");
+    }
+
+    string index     = vm["index-file"].as<string>();
+    string reference = vm["reference-file"].as<string>();
+    call c { s };
+    rlz::serialize::load_stream(index.c_str(), reference.c_str(), c);
+    if (vm.count("output")) {
+      std::ofstream out(vm["output"].as<string>());
+      c.write_json(out, index, reference);
+    } else {
+      c.write_json(std::cout, index, reference);
+    }
+  } catch (std::exception &e) {
+    std::cerr << e.what() << "\n"
+              << "Command-line options:"  << "\n"
+              << desc << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -13,6 +13,7 @@
 #include <sdsl/io.hpp>
 
 #include <api.hpp>
+#include <build_stats.hpp>
 #include <classic_parse.hpp>
 #include <io.hpp>
 #include <generic_caller.hpp>
@@ -108,7 +109,9 @@ int main(int argc, char **argv)
         ("pointer-length,p", po::value<string>()->default_value("32"),
          ("Pointer size, in bits. Choices: " + options_string<BigLengths>() + ".").c_str())
         ("accelerate,a", po::value<string>(),
-         "Filename containing matching stats (optional)");
+         "Filename containing matching stats (optional)")
+        ("stats,s", po::value<string>()->implicit_value("table"),
+         "Print per-stage build statistics. Choices: table (default), json.");
 
     po::positional_options_description pd;
     pd.add("input-file", 1).add("reference-file", 1).add("output-file", 1).add("alphabet", 1);
@@ -138,6 +141,15 @@ int main(int argc, char **argv)
       throw std::logic_error(vtypes[1] + " is not a valid pointer size.");
     }
 
+    // Build statistics
+    if (vm.count("stats") > 0) {
+      auto format = vm["stats"].as<string>();
+      if (format != "table" and format != "json") {
+        throw std::logic_error(format + " is not a valid statistics format.");
+      }
+      rlz::instrument::registry::global().enable();
+    }
+
     std::cout << "--- Input:          " << infile << "\n"
               << "--- Reference:      " << reference << "\n"
               << "--- Alphabet        " << alphabet << "\n"
@@ -157,6 +169,15 @@ int main(int argc, char **argv)
     invoke ivk(infile, reference, outfile, matches);
     rlz::utils::call<Caller>(vtypes.begin(), vtypes.end(), ivk);
 
+    if (vm.count("stats") > 0) {
+      auto &stats = rlz::instrument::registry::global();
+      if (vm["stats"].as<string>() == "json") {
+        stats.print_json(std::cout);
+      } else {
+        stats.print_table(std::cout);
+      }
+    }
+
   } catch (std::exception &e) {
     std::cerr << e.what() << "\n"
               << "Command-line options:"  << "\n"
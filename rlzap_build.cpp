@@ -2,6 +2,8 @@
 #include <chrono>
 #include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <list>
 #include <string>
@@ -13,10 +15,16 @@
 #include <sdsl/io.hpp>
 
 #include <api.hpp>
+#include <autotune.hpp>
+#include <build_stats.hpp>
+#include <dumper.hpp>
+#include <get_matchings.hpp>
 #include <io.hpp>
 #include <generic_caller.hpp>
 #include <match_serialize.hpp>
 #include <parse_rlzap.hpp>
+#include <parse_rlzap_optimal.hpp>
+#include <size_estimate.hpp>
 #include <type_listing.hpp>
 
 struct small_prefix {
@@ -33,8 +41,11 @@ REGISTER(SamplePrefix, sample_prefix, "sampling");
 LIST(Prefix, SamplePrefix/*, FastPrefix,*/);
 
 REGISTER(Lcp32, rlz::alphabet::lcp_32, "lcp32");
+REGISTER(DNA, rlz::alphabet::dna<>, "dna");
+REGISTER(Int16, rlz::alphabet::Integer<16UL>, "int16");
+REGISTER(Int32, rlz::alphabet::Integer<32UL>, "int32");
 
-LIST(Alphabets, Lcp32);
+LIST(Alphabets, Lcp32, DNA, Int16, Int32);
 
 REGISTER(Value_2 , rlz::values::Size<2UL>,  "2");
 REGISTER(Value_4 , rlz::values::Size<4UL>,  "4");
@@ -43,10 +54,11 @@ REGISTER(Value_8 , rlz::values::Size<8UL>,  "8");
 REGISTER(Value_16, rlz::values::Size<16UL>, "16");
 REGISTER(Value_32, rlz::values::Size<32UL>, "32");
 REGISTER(Value_48, rlz::values::Size<48UL>, "48");
+REGISTER(Value_64, rlz::values::Size<64UL>, "64");
 LIST(LiteralLengths, Value_2, Value_4, Value_8);
 LIST(DiffLengths, Value_2, Value_4, Value_8);
 LIST(BigLengths, Value_32);
-LIST(SampleLengths, Value_16, Value_32, Value_48);
+LIST(SampleLengths, Value_16, Value_32, Value_48, Value_64);
 
 CALLER(Alphabets, Prefix, LiteralLengths, DiffLengths, BigLengths, SampleLengths);
 
@@ -56,6 +68,10 @@ size_t ab_bits(const std::string &s)
     return 32UL;
   } else if (s == "dna") {
     return 2UL;
+  } else if (s == "int16") {
+    return 16UL;
+  } else if (s == "int32") {
+    return 32UL;
   } else {
     std::stringstream ss;
     ss << "Unknown alphabet " << s;
@@ -63,6 +79,137 @@ size_t ab_bits(const std::string &s)
   }
 }
 
+template <typename Alphabet, typename GPrefix, typename LitLength, typename DiffSize, typename PtrSize, typename SampleLength>
+struct configuration {
+  using AlphabetType  = Alphabet;
+  using Prefix        = typename GPrefix::template type<rlz::vectors::dense, LitLength, SampleLength>;
+  using LiteralKeeper = rlz::api::LiteralKeeper<Prefix>;
+  using ParseKeeper   = rlz::api::ParseKeeper<PtrSize, DiffSize>;
+  using Supported     = rlz::serialize::is_supported<
+                          Alphabet,
+                          rlz::impl::Bind<ParseKeeper, Alphabet>,
+                          rlz::impl::Bind<LiteralKeeper, Alphabet>
+                        >;
+};
+
+// Whether a configuration is registered for serialization
+struct supported_probe {
+  bool value = false;
+
+  template <typename Alphabet, typename GPrefix, typename LitLength, typename DiffSize, typename PtrSize, typename SampleLength>
+  void call()
+  {
+    value = configuration<Alphabet, GPrefix, LitLength, DiffSize, PtrSize, SampleLength>::Supported::value;
+  }
+};
+
+// Matching statistics of the input against the reference
+class match_getter {
+  std::string input;
+  std::string reference;
+
+public:
+  std::vector<rlz::match> matches;
+  size_t ref_len = 0UL;
+
+  match_getter(std::string input, std::string reference) : input(input), reference(reference) { }
+
+  template <typename Alphabet>
+  void call()
+  {
+    std::ifstream input_stream { input, std::ifstream::in },
+                  ref_stream { reference, std::ifstream::in };
+    if (!input_stream or !ref_stream) {
+      throw std::logic_error("Input or reference not readable");
+    }
+    rlz::utils::stream_dumper ref_dump(ref_stream), input_dump(input_stream);
+    auto ms = rlz::get_relative_matches<Alphabet>(ref_dump, input_dump);
+    matches = std::move(std::get<0>(ms));
+    ref_len = std::get<1>(ms).size();
+  }
+};
+
+// Exact component sizes of every supported DiffSize, literal length and sampling interval, from
+// a single parse and without building any index
+template <typename Parser>
+class size_report {
+private:
+  std::string input;
+  std::string reference;
+  const std::vector<rlz::match> &matching_stats;
+  Parser parse;
+  std::vector<std::string> vtypes;
+
+  template <typename Alphabet>
+  void report(const typename Alphabet::Symbol *text, size_t ref_len, const std::vector<rlz::match> &matches)
+  {
+    auto to_sizes = [] (const std::vector<std::string> &v) {
+      std::vector<size_t> to_ret;
+      for (auto &s : v) { to_ret.push_back(std::stoul(s)); }
+      return to_ret;
+    };
+    auto sizes = rlz::estimate_sizes<Alphabet>(
+      text, ref_len, parse, matches.begin(), matches.end(),
+      to_sizes(rlz::utils::options<DiffLengths>()),
+      to_sizes(rlz::utils::options<LiteralLengths>()),
+      to_sizes(rlz::utils::options<SampleLengths>())
+    );
+
+    std::cout << "--- Estimated sizes, in bytes (" << matches.size() << " symbols)\n"
+              << std::setw(6) << "Diff" << std::setw(6) << "Lit" << std::setw(8) << "Sample"
+              << std::setw(12) << "Blocks" << std::setw(12) << "Subphrases"
+              << std::setw(12) << "Phrase BV" << std::setw(12) << "Subph. BV" << std::setw(12) << "Pointers"
+              << std::setw(12) << "Diffs" << std::setw(12) << "Lit. lens" << std::setw(10) << "Samples"
+              << std::setw(12) << "Literals" << std::setw(14) << "Total" << std::setw(10) << "Bits/sym" << "\n";
+    for (auto &c : sizes) {
+      auto v = vtypes;
+      v[2] = std::to_string(c.lit_bits);
+      v[3] = std::to_string(c.diff_bits);
+      v[5] = std::to_string(c.sample);
+      supported_probe probe;
+      rlz::utils::call<Caller>(v.begin(), v.end(), probe);
+      if (!probe.value) {
+        continue;
+      }
+      std::cout << std::setw(6) << c.diff_bits << std::setw(6) << c.lit_bits << std::setw(8) << c.sample
+                << std::setw(12) << c.blocks << std::setw(12) << c.subphrases
+                << std::setw(12) << c.phrase_bv << std::setw(12) << c.subphrase_bv << std::setw(12) << c.ptrs
+                << std::setw(12) << c.diffs << std::setw(12) << c.lit_lengths << std::setw(10) << c.lit_samples
+                << std::setw(12) << c.literals << std::setw(14) << c.total()
+                << std::fixed << std::setprecision(3)
+                << std::setw(10) << 8.0 * c.total() / std::max<size_t>(1UL, matches.size())
+                << std::defaultfloat << "\n";
+    }
+    std::cout << std::endl;
+  }
+
+public:
+  size_report(
+    std::string input, std::string reference, Parser parse, const std::vector<rlz::match> &matching_stats,
+    std::vector<std::string> vtypes
+  ) : input(input), reference(reference), matching_stats(matching_stats), parse(parse), vtypes(vtypes)
+  { }
+
+  template <typename Alphabet>
+  void call()
+  {
+    using Symbol = typename Alphabet::Symbol;
+    std::ifstream input_stream { input, std::ifstream::in },
+                  ref_stream { reference, std::ifstream::in };
+    if (!input_stream or !ref_stream) {
+      throw std::logic_error("Input or reference not readable");
+    }
+    if (matching_stats.empty()) {
+      rlz::utils::stream_dumper ref_dump(ref_stream), input_dump(input_stream);
+      auto ms = rlz::get_relative_matches<Alphabet>(ref_dump, input_dump);
+      report<Alphabet>(std::get<2>(ms).data(), std::get<1>(ms).size(), std::get<0>(ms));
+    } else {
+      auto text = rlz::io::read_stream<Symbol>(input_stream);
+      report<Alphabet>(text.get(), rlz::io::stream_length(ref_stream) / sizeof(Symbol), matching_stats);
+    }
+  }
+};
+
 template <typename Parser>
 class invoke {
 private:
@@ -71,6 +218,7 @@ private:
   std::string output;
   std::vector<rlz::match> matching_stats;
   Parser parse;
+  rlz::build::phrase_bounds bounds;
 
   template <typename Index>
   void process(Index &idx) {
@@ -83,27 +231,26 @@ private:
     std::cout << duration_cast<milliseconds>(t_2 - t_1).count() << " ms" << std::endl;
   }
 
-public:
-
-  template <typename MS>
-  invoke(std::string input, std::string reference, std::string output, Parser parse, MS &&matching_stats)
-    : input(input),  reference(reference),  output(output), 
-      matching_stats(std::forward<MS>(matching_stats)),
-      parse(parse)
-  { }
+  // Unregistered configurations are never built: they could not be stored anyway, and pruning
+  // them here keeps the construct/store instantiations down to the registered ones.
+  template <typename Config>
+  void build(std::false_type)
+  {
+    throw std::logic_error("This configuration is not registered for serialization (see serialize::supported)");
+  }
 
-  template <typename Alphabet, typename GPrefix, typename LitLength, typename DiffSize, typename PtrSize, typename SampleLengths>
-  void call()
+  template <typename Config>
+  void build(std::true_type)
   {
     using namespace std::chrono;
-    using Prefix        = typename GPrefix::template type<rlz::vectors::dense, LitLength, SampleLengths>;
-    using LiteralKeeper = rlz::api::LiteralKeeper<Prefix>;
-    using ParseKeeper   = rlz::api::ParseKeeper<PtrSize, DiffSize>;
+    using Alphabet      = typename Config::AlphabetType;
+    using LiteralKeeper = typename Config::LiteralKeeper;
+    using ParseKeeper   = typename Config::ParseKeeper;
 
     auto t_1 = high_resolution_clock::now();
     if (matching_stats.empty()) {
       std::cout << "=== Building index... " << std::endl;
-      auto index = rlz::construct_sstream<Alphabet, ParseKeeper, LiteralKeeper>(input.c_str(), reference.c_str(), parse);
+      auto index = rlz::construct_sstream<Alphabet, ParseKeeper, LiteralKeeper>(input.c_str(), reference.c_str(), parse, bounds);
       auto t_2 = high_resolution_clock::now();
       std::cout << "=== Build time: " << duration_cast<milliseconds>(t_2 - t_1).count() << " ms" << std::endl;
       process(index);
@@ -111,15 +258,50 @@ public:
       std::cout << "=== Building index (accelerated)... " << std::endl;
       auto m_begin = matching_stats.begin();
       auto m_end   = matching_stats.end();
-      auto index = rlz::construct_sstream<Alphabet, ParseKeeper, LiteralKeeper>(input.c_str(), reference.c_str(), parse, m_begin, m_end);
+      auto index = rlz::construct_sstream<Alphabet, ParseKeeper, LiteralKeeper>(input.c_str(), reference.c_str(), parse, m_begin, m_end, bounds);
       auto t_2 = high_resolution_clock::now();
       std::cout << "=== Build time: " << duration_cast<milliseconds>(t_2 - t_1).count() << " ms" << std::endl;
       process(index);
     }
   }
+
+public:
+
+  template <typename MS>
+  invoke(
+    std::string input, std::string reference, std::string output, Parser parse, MS &&matching_stats,
+    rlz::build::phrase_bounds bounds = rlz::build::phrase_bounds()
+  ) : input(input),  reference(reference),  output(output), 
+      matching_stats(std::forward<MS>(matching_stats)),
+      parse(parse), bounds(bounds)
+  { }
+
+  template <typename Alphabet, typename GPrefix, typename LitLength, typename DiffSize, typename PtrSize, typename SampleLengths>
+  void call()
+  {
+    using Config = configuration<Alphabet, GPrefix, LitLength, DiffSize, PtrSize, SampleLengths>;
+    build<Config>(typename Config::Supported{});
+  }
 };
 
-enum struct Parser { classic, rlzap_automatic, rlzap_parameter };
+// Builds the index, or only reports the size of every supported configuration with estimate
+template <typename ParseType>
+void run(
+  const ParseType &parse, bool estimate, const std::string &input, const std::string &reference,
+  const std::string &output, const std::vector<rlz::match> &matches, const std::vector<std::string> &vtypes,
+  rlz::build::phrase_bounds bounds
+)
+{
+  if (estimate) {
+    size_report<ParseType> report(input, reference, parse, matches, vtypes);
+    rlz::utils::call<rlz::utils::Caller<Alphabets>>(vtypes[0], report);
+  } else {
+    invoke<ParseType> ivk(input, reference, output, parse, matches, bounds);
+    rlz::utils::call<Caller>(vtypes.begin(), vtypes.end(), ivk);
+  }
+}
+
+enum struct Parser { classic, rlzap_automatic, rlzap_parameter, rlzap_optimal };
 
 #define MAP_NAME(var, name, field) if (var == "name") { return Parser::field; }
 
@@ -128,6 +310,7 @@ enum Parser name_to_parser(std::string name)
   if (name == "classic") { return Parser::classic; }
   if (name == "automatic") { return Parser::rlzap_automatic; }
   if (name == "parametric") { return Parser::rlzap_parameter; }
+  if (name == "optimal") { return Parser::rlzap_optimal; }
   throw std::logic_error(name + " is not a valid parsing strategy");
 }
 
@@ -139,6 +322,8 @@ std::string parser_to_name(enum Parser kind) {
     return "parametric";
   case Parser::rlzap_automatic:
     return "automatic";
+  case Parser::rlzap_optimal:
+    return "optimal";
   default:
     throw std::logic_error("parser_to_name: unhandled case");
   }
@@ -149,10 +334,197 @@ std::string parser_choices()
   std::stringstream ss;
   ss << parser_to_name(Parser::classic) << ", "
      << parser_to_name(Parser::rlzap_automatic) << ", "
-     << parser_to_name(Parser::rlzap_parameter) << ", ";
+     << parser_to_name(Parser::rlzap_parameter) << ", "
+     << parser_to_name(Parser::rlzap_optimal);
   return ss.str();
 }
 
+// A point of the autotune grid
+struct tune_candidate {
+  Parser      parser;
+  size_t      E_L;
+  size_t      P_T;
+  double      penalty;
+  std::string lit;
+  std::string diff;
+  std::string sample;
+  rlz::tune::estimate est;
+};
+
+// Shape and exact component sizes of the parse of the sampled windows
+struct tune_parse_result {
+  rlz::tune::parse_stats                      stats;
+  std::vector<rlz::estimate::component_sizes> sizes;    // Summed over the windows
+};
+
+// Parse the sampled windows of the matching statistics, as seen by the keepers; texts holds the
+// input symbols of every window, for the literals
+template <typename Alphabet, typename ParseType>
+tune_parse_result tune_parse(
+  const ParseType &parse, const std::vector<rlz::match> &matches, size_t ref_len,
+  const std::vector<std::pair<size_t, size_t>> &windows,
+  const std::vector<std::vector<typename Alphabet::Symbol>> &texts,
+  size_t diff_bits, const std::vector<size_t> &lit_widths, const std::vector<size_t> &samples
+)
+{
+  using Symbol = typename Alphabet::Symbol;
+  tune_parse_result to_ret { rlz::tune::parse_stats(diff_bits), {} };
+  for (auto i = 0UL; i < windows.size(); ++i) {
+    auto ms     = rlz::tune::window(matches.begin(), windows[i].first, windows[i].second);
+    auto offset = windows[i].first;
+    rlz::size_estimator<Alphabet, const Symbol*> est(texts[i].data(), { diff_bits }, lit_widths, offset);
+    parse(
+      ms.begin(), ms.end(), ref_len,
+      [&] (size_t pos, size_t len) {
+        to_ret.stats.literal(offset + pos, len);
+        est.literal_evt(offset + pos, len);
+      },
+      [&] (size_t pos, size_t ptr, size_t len) {
+        to_ret.stats.copy(offset + pos, ptr, len);
+        est.copy_evt(offset + pos, ptr, len);
+      },
+      [&] () { est.end_evt(); }
+    );
+    auto sizes = est.sizes(samples);
+    if (to_ret.sizes.empty()) {
+      to_ret.sizes = std::move(sizes);
+    } else {
+      for (auto s = 0UL; s < sizes.size(); ++s) {
+        to_ret.sizes[s] += sizes[s];
+      }
+    }
+  }
+  return to_ret;
+}
+
+// Symbols of the sampled windows of the input
+template <typename Symbol>
+std::vector<std::vector<Symbol>> window_texts(const std::string &input, const std::vector<std::pair<size_t, size_t>> &windows)
+{
+  std::ifstream in(input, std::ifstream::in | std::ifstream::binary);
+  if (!in) {
+    throw std::logic_error("Input not readable");
+  }
+  std::vector<std::vector<Symbol>> to_ret;
+  for (auto &w : windows) {
+    to_ret.emplace_back(w.second - w.first);
+    in.seekg(w.first * sizeof(Symbol));
+    rlz::io::read_data(in, to_ret.back().data(), to_ret.back().size());
+  }
+  return to_ret;
+}
+
+// Estimates size and extraction cost of every parser, DiffSize, literal length and sampling
+// interval in the grid, and chooses the cheapest configuration on the Pareto front whose size
+// is within slack of the smallest one. Sizes are the exact ones of size_estimator on the sampled
+// windows. Literal lengths and sampling intervals do not change greedy parses, so one parse
+// prices all of them.
+class tuner {
+  std::string                    input;
+  const std::vector<rlz::match> &matches;
+  size_t                         ref_len;
+  std::vector<std::string>       vtypes;
+  size_t                         sample;
+  size_t                         extract_len;
+  double                         slack;
+
+public:
+  tune_candidate chosen;
+
+  tuner(
+    std::string input, const std::vector<rlz::match> &matches, size_t ref_len, std::vector<std::string> vtypes,
+    size_t sample, size_t extract_len, double slack
+  ) : input(input), matches(matches), ref_len(ref_len), vtypes(vtypes), sample(sample),
+      extract_len(extract_len), slack(slack)
+  { }
+
+  template <typename Alphabet>
+  void call()
+  {
+    auto to_sizes = [] (const std::vector<std::string> &v) {
+      std::vector<size_t> to_ret;
+      for (auto &s : v) { to_ret.push_back(std::stoul(s)); }
+      return to_ret;
+    };
+    const size_t sym_bits = ab_bits(vtypes[0]);
+    const size_t abs_bits = std::stoi(vtypes[4]);
+    const auto samples    = to_sizes(rlz::utils::options<SampleLengths>());
+    auto windows          = rlz::tune::sample_windows(matches.size(), sample);
+    auto texts            = window_texts<typename Alphabet::Symbol>(input, windows);
+
+    std::vector<tune_candidate> candidates;
+    auto add = [&] (const tune_parse_result &parsed, tune_candidate c) {
+      for (auto &size : parsed.sizes) {
+        vtypes[2] = std::to_string(size.lit_bits);
+        vtypes[3] = c.diff;
+        vtypes[5] = std::to_string(size.sample);
+        supported_probe probe;
+        rlz::utils::call<Caller>(vtypes.begin(), vtypes.end(), probe);
+        if (probe.value) {
+          c.lit    = vtypes[2];
+          c.sample = vtypes[5];
+          c.est    = rlz::tune::estimate {
+            8.0 * size.total(), rlz::tune::extraction_cost(parsed.stats, size.lit_bits, size.sample, extract_len)
+          };
+          candidates.push_back(c);
+        }
+      }
+    };
+
+    const auto lits = to_sizes(rlz::utils::options<LiteralLengths>());
+    for (auto &diff : rlz::utils::options<DiffLengths>()) {
+      size_t rlt_bits = std::stoi(diff);
+      {
+        rlz::parser_rlzap parse{rlt_bits, abs_bits, sym_bits};
+        auto parsed = tune_parse<Alphabet>(parse, matches, ref_len, windows, texts, rlt_bits, lits, samples);
+        add(parsed, tune_candidate { Parser::rlzap_automatic, 0UL, 0UL, 0.0, "", diff, "", {} });
+      }
+      for (size_t E_L : { 8UL, 16UL, 32UL, 64UL }) {
+        for (size_t P_T : { 8UL, 16UL, 32UL }) {
+          rlz::parser_rlzap parse{rlt_bits, abs_bits, sym_bits, E_L, P_T};
+          auto parsed = tune_parse<Alphabet>(parse, matches, ref_len, windows, texts, rlt_bits, lits, samples);
+          add(parsed, tune_candidate { Parser::rlzap_parameter, E_L, P_T, 0.0, "", diff, "", {} });
+        }
+      }
+      // The optimal parse depends on the literal length
+      for (auto lit : lits) {
+        for (double penalty : { 0.0, 32.0 }) {
+          rlz::parser_rlzap_optimal<> parse{
+            rlt_bits, rlz::optimal::bit_cost{rlt_bits, abs_bits, sym_bits, lit, penalty}
+          };
+          auto parsed = tune_parse<Alphabet>(parse, matches, ref_len, windows, texts, rlt_bits, { lit }, samples);
+          add(parsed, tune_candidate { Parser::rlzap_optimal, 0UL, 0UL, penalty, "", diff, "", {} });
+        }
+      }
+    }
+    if (candidates.empty()) {
+      throw std::logic_error("Autotune: no supported configuration for alphabet " + vtypes[0]);
+    }
+
+    auto front  = rlz::tune::pareto_front(candidates);
+    auto &best  = rlz::tune::choose(front, slack);
+    chosen      = best;
+
+    size_t symbols = 0UL;
+    for (auto &w : windows) { symbols += w.second - w.first; }
+    std::cout << "--- Autotune: " << candidates.size() << " configurations, " << symbols << " symbols sampled, "
+              << front.size() << " on the Pareto front\n"
+              << "      " << std::left << std::setw(12) << "Parser" << std::right
+              << std::setw(6) << "E_L" << std::setw(6) << "P_T" << std::setw(9) << "Penalty"
+              << std::setw(7) << "Diff" << std::setw(6) << "Lit" << std::setw(8) << "Sample"
+              << std::setw(12) << "Bits/sym" << std::setw(10) << "Cost" << "\n";
+    for (auto &c : front) {
+      std::cout << (&c == &best ? "  *   " : "      ") << std::left << std::setw(12) << parser_to_name(c.parser) << std::right
+                << std::setw(6) << c.E_L << std::setw(6) << c.P_T << std::setw(9) << c.penalty
+                << std::setw(7) << c.diff << std::setw(6) << c.lit << std::setw(8) << c.sample
+                << std::fixed << std::setprecision(3)
+                << std::setw(12) << c.est.bits / std::max<size_t>(1UL, symbols)
+                << std::setw(10) << c.est.cost << std::defaultfloat << "\n";
+    }
+    std::cout << std::endl;
+  }
+};
+
 int main(int argc, char **argv)
 {
   using std::string;
@@ -172,26 +544,44 @@ int main(int argc, char **argv)
          "Reference file.")
         ("alphabet,A", po::value<string>()->default_value(default_ab.c_str()),
          ("Alphabet. Choices: " + options_string<Alphabets>()).c_str())
-        ("output-file,o", po::value<string>()->required(),
-         "Output file.")
+        ("output-file,o", po::value<string>(),
+         "Output file (not needed with --estimate).")
         ("parser,k", po::value<string>()->default_value(parser_to_name(Parser::rlzap_parameter).c_str()),
           ("Select a parsing strategy. Choices: " + parser_choices()).c_str())
         ("look-ahead,L", po::value<size_t>()->default_value(30UL),
          "Amount of look-ahead symbols.")
         ("explicit-len,E", po::value<size_t>()->default_value(15UL),
          "Minimum length of an explicit phrase, in symbols.")
+        ("phrase-penalty,P", po::value<double>()->default_value(0.0),
+         "Optimal parser: extra bits charged to every phrase, trading space for faster extraction.")
         ("literal-strategy,l", po::value<string>()->default_value("bv"),
          ("Literal lengths datastructure implementation. Choices: " + options_string<Prefix>() + ".").c_str())
         ("max-lit,M", po::value<string>()->default_value("4"),
          ("Length of end-of-phrase literal length, in bits. Choices: " + options_string<LiteralLengths>() + ".").c_str())
-        ("sample-int,S", po::value<string>()->default_value("32"),
+        ("sample-int,S", po::value<string>()->default_value("64"),
          ("Literal sampling interval size, in elements. Choices: " + options_string<SampleLengths>() + ".").c_str())
         ("delta-bits,d", po::value<string>()->default_value("8"),
          ("Adaptive pointer length, in bits. Choices: " + options_string<DiffLengths>() + ".").c_str())
         ("explicit-bits,e", po::value<string>()->default_value("32"),
          ("Explicit pointer length, in bits. Choices: " + options_string<BigLengths>() + ".").c_str())
         ("accelerate,a", po::value<string>(),
-         "File containing matching stats (optional)");
+         "File containing matching stats (optional)")
+        ("stats,s", po::value<string>()->implicit_value("table"),
+         "Print per-stage build statistics. Choices: table (default), json.")
+        ("autotune,T", po::value<double>()->implicit_value(0.05),
+         "Choose parser, literal length, subphrase pointer size and sampling interval: the fastest estimated "
+         "configuration whose size is within the given fraction (default 0.05) of the smallest one.")
+        ("tune-sample", po::value<size_t>()->default_value(1UL << 22),
+         "Autotune: input symbols to parse for each configuration (0: the whole input).")
+        ("tune-length", po::value<size_t>()->default_value(64UL),
+         "Autotune: length of the extractions to optimize for.")
+        ("estimate", po::bool_switch()->default_value(false),
+         "Print the exact size of every component for every supported subphrase pointer size, literal length "
+         "and sampling interval, without building the index.")
+        ("max-phrase-len,m", po::value<size_t>()->default_value(0UL),
+         "Maximum subphrase length, in symbols, bounding the work of each access (0: unbounded).")
+        ("block-len,B", po::value<size_t>()->default_value(0UL),
+         "Start a new block, with an absolute pointer, every given number of symbols (0: disabled).");
 
     po::positional_options_description pd;
     pd.add("input-file", 1).add("reference-file", 1).add("output-file", 1).add("alphabet", 1);
@@ -207,10 +597,16 @@ int main(int argc, char **argv)
     string infile     = vm["input-file"].as<string>();
     string reference  = vm["reference-file"].as<string>();
     string alphabet   = vm["alphabet"].as<string>();
-    string outfile    = vm["output-file"].as<string>();
+    bool estimate     = vm["estimate"].as<bool>();
+    if (!estimate and vm.count("output-file") == 0) {
+      throw std::logic_error("Output file not specified");
+    }
+    string outfile    = estimate ? "" : vm["output-file"].as<string>();
     Parser parser     = name_to_parser(vm["parser"].as<string>());
     size_t E_L        = vm["look-ahead"].as<size_t>();
     size_t P_T        = vm["explicit-len"].as<size_t>();
+    double penalty    = vm["phrase-penalty"].as<double>();
+    rlz::build::phrase_bounds bounds(vm["max-phrase-len"].as<size_t>(), vm["block-len"].as<size_t>());
     std::vector<std::string> vtypes {{
       alphabet,
       vm["literal-strategy"].as<string>(),
@@ -240,11 +636,69 @@ int main(int argc, char **argv)
       throw std::logic_error(vtypes[5] + " is not a valid sampling interval.");
     }
 
+    if (estimate and bounds.any()) {
+      throw std::logic_error("--estimate does not model --max-phrase-len and --block-len");
+    }
+    if (vm.count("autotune") > 0 and bounds.any()) {
+      throw std::logic_error("--autotune does not model --max-phrase-len and --block-len");
+    }
+
+    // Build statistics
+    if (vm.count("stats") > 0) {
+      auto format = vm["stats"].as<string>();
+      if (format != "table" and format != "json") {
+        throw std::logic_error(format + " is not a valid statistics format.");
+      }
+      rlz::instrument::registry::global().enable();
+    }
+
+    // Load matching stats
+    std::vector<rlz::match> matches;
+    if (vm.count("accelerate") > 0) {
+      std::ifstream match_stream(vm["accelerate"].as<string>());
+      if (!match_stream.good()) {
+        throw std::logic_error("Match file not readable");
+      }
+      matches = rlz::serialize::matches::load(match_stream);
+    }
+
+    // Autotune: parse with every configuration of the grid and keep the chosen one
+    if (vm.count("autotune") > 0) {
+      auto slack = vm["autotune"].as<double>();
+      if (slack < 0.0) {
+        throw std::logic_error("Autotune slack must be non-negative");
+      }
+      size_t ref_len = 0UL;
+      if (matches.empty()) {
+        std::cout << "=== Computing matching statistics for autotune... " << std::endl;
+        match_getter getter(infile, reference);
+        rlz::utils::call<rlz::utils::Caller<Alphabets>>(alphabet, getter);
+        matches = std::move(getter.matches);
+        ref_len = getter.ref_len;
+      }
+      auto sample = vm["tune-sample"].as<size_t>();
+      tuner tune(
+        infile, matches, ref_len, vtypes, sample > 0UL ? sample : matches.size(), vm["tune-length"].as<size_t>(), slack
+      );
+      rlz::utils::call<rlz::utils::Caller<Alphabets>>(alphabet, tune);
+      auto &c = tune.chosen;
+      parser    = c.parser;
+      penalty   = c.penalty;
+      vtypes[2] = c.lit;
+      vtypes[3] = c.diff;
+      vtypes[5] = c.sample;
+      if (parser == Parser::rlzap_parameter) {
+        E_L = c.E_L;
+        P_T = c.P_T;
+      }
+    }
+
     std::cout << "--- Input:          " << infile << "\n"
               << "--- Reference:      " << reference << "\n"
               << "--- Alphabet        " << alphabet << "\n"
               << "--- Output:         " << outfile << "\n"
               << "--- Parser:         " << parser_to_name(parser) << "\n"
+              << "--- Phrase penalty: " << penalty << "\n"
               << "--- Edit distance:  " << E_L << "\n"
               << "--- Phrase thsld:   " << P_T << "\n"
               << "--- Literal impl:   " << vtypes[1] << "\n"
@@ -252,35 +706,37 @@ int main(int argc, char **argv)
               << "--- Literal sample: " << vtypes[5] << "\n"
               << "--- Subphrase size: " << vtypes[3] << "\n"
               << "--- Pointer size:   " << vtypes[4] << "\n"
+              << "--- Max phrase len: " << bounds.max_len << "\n"
+              << "--- Block length:   " << bounds.block_len << "\n"
               << std::endl;
 
-    // Load matching stats
-    std::vector<rlz::match> matches;
-    if (vm.count("accelerate") > 0) {
-      std::ifstream match_stream(vm["accelerate"].as<string>());
-      if (!match_stream.good()) {
-        throw std::logic_error("Match file not readable");
-      }
-      matches = rlz::serialize::matches::load(match_stream);
-    }
     // Invoke function
     if (parser == Parser::classic) {
-      invoke<rlz::Parser> ivk(infile, reference, outfile, rlz::Parser{E_L, P_T}, matches);
-      rlz::utils::call<Caller>(vtypes.begin(), vtypes.end(), ivk);
+      run(rlz::Parser{E_L, P_T}, estimate, infile, reference, outfile, matches, vtypes, bounds);
     } else {
       size_t rlt_bits = std::stoi(vtypes[3]);
       size_t abs_bits = std::stoi(vtypes[4]);
       size_t sym_bits = ab_bits(alphabet);
-      rlz::parser_rlzap parse;
       if (parser == Parser::rlzap_automatic) {
         rlz::parser_rlzap parse{rlt_bits, abs_bits, sym_bits};
-        invoke<rlz::parser_rlzap> ivk(infile, reference, outfile, parse, matches);
-        rlz::utils::call<Caller>(vtypes.begin(), vtypes.end(), ivk);            
+        run(parse, estimate, infile, reference, outfile, matches, vtypes, bounds);
+      } else if (parser == Parser::rlzap_optimal) {
+        size_t lit_bits = std::stoi(vtypes[2]);
+        rlz::parser_rlzap_optimal<> parse{rlt_bits, rlz::optimal::bit_cost{rlt_bits, abs_bits, sym_bits, lit_bits, penalty}};
+        run(parse, estimate, infile, reference, outfile, matches, vtypes, bounds);
       } else {
         assert(parser == Parser::rlzap_parameter);
         rlz::parser_rlzap parse{rlt_bits, abs_bits, sym_bits, E_L, P_T};
-        invoke<rlz::parser_rlzap> ivk(infile, reference, outfile, parse, matches);
-        rlz::utils::call<Caller>(vtypes.begin(), vtypes.end(), ivk);            
+        run(parse, estimate, infile, reference, outfile, matches, vtypes, bounds);
+      }
+    }
+
+    if (vm.count("stats") > 0) {
+      auto &stats = rlz::instrument::registry::global();
+      if (vm["stats"].as<string>() == "json") {
+        stats.print_json(std::cout);
+      } else {
+        stats.print_table(std::cout);
       }
     }
 
@@ -0,0 +1,107 @@
+#include <any_index.hpp>
+#include <api.hpp>
+#include <parse_rlzap.hpp>
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "main.hpp"
+
+using namespace rlz;
+
+class AnyIndex : public ::testing::Test {
+public:
+  using Alphabet = alphabet::dna<>;
+  using Parse    = api::ParseKeeper<values::Size<32UL>, values::Size<4UL>>;
+  using Literal  = api::LiteralKeeper<prefix::sampling_cumulative<values::Size<4UL>, values::Size<64UL>>>;
+
+  std::string reference;
+  std::string input;
+  any_index idx;
+  std::vector<std::tuple<std::int64_t, size_t, size_t>> phrases;
+
+  virtual void SetUp()
+  {
+    std::default_random_engine rg(42U);
+    std::uniform_int_distribution<int> base(0, 3);
+    std::uniform_int_distribution<size_t> pos(0U, 4000U);
+    for (auto i = 0U; i < 5000U; ++i) {
+      reference.push_back("ACGT"[base(rg)]);
+    }
+    while (input.size() < 20000U) {
+      input += reference.substr(pos(rg), 300U);
+      input.push_back("ACGT"[base(rg)]);
+    }
+
+    std::vector<char> ref_v(reference.begin(), reference.end());
+    auto index = construct_iterator<Alphabet, Parse, Literal>(
+      input.begin(), input.end(), iterator_container<Alphabet, std::vector<char>::iterator>(ref_v.begin(), ref_v.end()), parser_rlzap{}
+    );
+    auto record = [&] (std::int64_t offset, size_t copy_len, size_t lit_len) {
+      phrases.emplace_back(offset, copy_len, lit_len);
+    };
+    index.process_parsing(record);
+
+    std::stringstream stored;
+    serialize::store(index, stored);
+    std::istringstream ref_stream(reference);
+    idx = any_index::load(stored, ref_stream);
+  }
+};
+
+TEST_F(AnyIndex, Extract)
+{
+  ASSERT_EQ(input.size(), idx.size());
+  ASSERT_EQ(1U, idx.symbol_bytes());
+  auto all = idx.extract(0UL, idx.size());
+  ASSERT_EQ(input, std::string(all.begin(), all.end()));
+  auto part = idx.extract(1234UL, 5678UL);
+  ASSERT_EQ(input.substr(1234UL, 5678UL - 1234UL), std::string(part.begin(), part.end()));
+  ASSERT_THROW(idx.extract(0UL, idx.size() + 1), std::logic_error);
+}
+
+TEST_F(AnyIndex, ExtractBatch)
+{
+  std::default_random_engine rg(7U);
+  std::uniform_int_distribution<size_t> pos(0U, input.size());
+  std::vector<any_index::range> ranges;
+  std::string expected;
+  for (auto i = 0U; i < 100U; ++i) {
+    auto a = pos(rg), b = pos(rg);
+    ranges.emplace_back(std::min(a, b), std::max(a, b));
+    expected += input.substr(std::min(a, b), std::max(a, b) - std::min(a, b));
+  }
+  std::vector<char> out(expected.size());
+  idx.extract_batch(ranges, out.data());
+  ASSERT_EQ(expected, std::string(out.begin(), out.end()));
+}
+
+TEST_F(AnyIndex, DecompressRange)
+{
+  std::ostringstream out;
+  idx.decompress_range(100UL, idx.size(), out, 777UL);
+  ASSERT_EQ(input.substr(100UL), out.str());
+}
+
+TEST_F(AnyIndex, ProcessParsing)
+{
+  decltype(phrases) got;
+  auto visit = [&] (const any_index::phrase *p, size_t n) {
+    ASSERT_LE(n, 64UL);
+    for (auto i = 0UL; i < n; ++i) {
+      got.emplace_back(p[i].offset, p[i].copy_len, p[i].lit_len);
+    }
+  };
+  idx.process_parsing(visit, 64UL);
+  ASSERT_EQ(phrases, got);
+}
+
+TEST(AnyIndexEmpty, Throws)
+{
+  any_index idx;
+  ASSERT_THROW(idx.size(), std::logic_error);
+}
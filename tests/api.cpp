@@ -9,6 +9,8 @@
 #include <parse_keeper.hpp>
 #include <get_matchings.hpp>
 
+#include <cstdio>
+#include <fstream>
 #include <iterator>
 #include <sstream>
 #include <vector>
@@ -299,6 +301,35 @@ TYPED_TEST(Api, ConstructAcceleratedPtr)
   check_iterable(input, output);
 }
 
+TYPED_TEST(Api, ConstructBounded)
+{
+  using Alphabet  = typename Api<TypeParam>::Alphabet;
+  using Symbol    = typename Alphabet::Symbol;
+  using Parse     = typename Api<TypeParam>::Parse;
+  using Literal   = typename Api<TypeParam>::Literal;
+  auto input     = this->input_get();
+  auto ref_cont  = this->reference_container();
+  const size_t max_len = 10UL, block_len = 32UL;
+  auto index = construct_iterator<Alphabet, Parse, Literal>(
+    input.begin(), input.end(), ref_cont, ProperParser<Parse>{}, build::phrase_bounds(max_len, block_len)
+  );
+  std::vector<Symbol> output;
+  index(0UL, index.size(), std::back_inserter(output));
+  check_iterable(input, output);
+
+  // Every subphrase is short, and every multiple of block_len starts one
+  size_t position = 0UL, aligned = 0UL;
+  auto check = [&] (std::int64_t, size_t phrase_len, size_t) {
+    EXPECT_LE(phrase_len, max_len);
+    EXPECT_EQ(position / block_len, (position + phrase_len - 1UL) / block_len);
+    aligned  += position % block_len == 0UL;
+    position += phrase_len;
+  };
+  index.process_parsing(check);
+  EXPECT_EQ(position, input.size());
+  EXPECT_EQ(aligned, (input.size() + block_len - 1UL) / block_len);
+}
+
 template <typename Alphabet>
 struct UseLoad {
 
@@ -368,3 +399,150 @@ TYPED_TEST(Api, LoadStreamStore)
   UseLoad<Alphabet> caller(input);
   serialize::load_stream(stored, reference_ss, caller);
 }
+
+TEST(ApiRegistry, CompactAlphabets)
+{
+  using Parse    = api::ParseKeeper<values::Size<32UL>, values::Size<4UL>>;
+  using Wide     = api::LiteralKeeper<prefix::sampling_cumulative<values::Size<4UL>, values::Size<64UL>>>;
+  using Narrow   = api::LiteralKeeper<prefix::sampling_cumulative<values::Size<4UL>, values::Size<32UL>>>;
+  using DNA      = rlz::alphabet::dna<>;
+  using Int16    = rlz::alphabet::Integer<16UL>;
+  constexpr bool dna_wide     = serialize::is_supported<DNA, impl::Bind<Parse, DNA>, impl::Bind<Wide, DNA>>::value;
+  constexpr bool int_wide     = serialize::is_supported<Int16, impl::Bind<Parse, Int16>, impl::Bind<Wide, Int16>>::value;
+  constexpr bool dna_narrow   = serialize::is_supported<DNA, impl::Bind<Parse, DNA>, impl::Bind<Narrow, DNA>>::value;
+  ASSERT_TRUE(dna_wide);
+  ASSERT_TRUE(int_wide);
+  ASSERT_FALSE(dna_narrow);
+}
+
+class ApiFormat : public ::testing::Test {
+public:
+  using Alphabet  = rlz::alphabet::dna<>;
+  using Parse     = api::ParseKeeper<values::Size<32UL>, values::Size<4UL>>;
+  using Literal   = api::LiteralKeeper<prefix::sampling_cumulative<values::Size<4UL>, values::Size<64UL>>>;
+  using Reference = iterator_container<Alphabet, std::vector<char>::iterator>;
+  using Index     = impl::Index<Alphabet, container_wrapper<Alphabet, Reference>, Parse, Literal>;
+
+  std::vector<char> reference { reference_char.begin(), reference_char.end() };
+  std::vector<char> input     { source_char.begin(), source_char.end() };
+
+  Index build()
+  {
+    return construct_iterator<Alphabet, Parse, Literal>(
+      input.begin(), input.end(), Reference(reference.begin(), reference.end()), parser_rlzap{}
+    );
+  }
+};
+
+TEST(Crc32c, CheckValue)
+{
+  ASSERT_EQ(0xE3069283U, serialize::format::crc32c(std::string("123456789")));
+}
+
+TEST_F(ApiFormat, Verify)
+{
+  std::stringstream stored;
+  serialize::store(build(), stored);
+  auto hdr = serialize::verify(stored);
+  ASSERT_EQ(serialize::format::version, hdr.version);
+  ASSERT_EQ(reference.size(), hdr.reference_len);
+  ASSERT_EQ(2U, hdr.sections.size());
+}
+
+TEST_F(ApiFormat, RejectsOtherReference)
+{
+  std::stringstream stored;
+  serialize::store(build(), stored);
+  UseLoad<Alphabet> caller(input);
+  ASSERT_THROW(
+    serialize::load_reference<Alphabet>(stored, Reference(reference.begin(), std::prev(reference.end())), caller),
+    std::logic_error
+  );
+
+  stored.clear();
+  stored.seekg(0);
+  Index idx;
+  idx.set_source(container_wrapper<Alphabet, Reference>(Reference(reference.begin(), std::prev(reference.end()))));
+  ASSERT_THROW(serialize::load_into(stored, idx), std::logic_error);
+}
+
+TEST_F(ApiFormat, DetectsCorruption)
+{
+  std::stringstream stored;
+  serialize::store(build(), stored);
+  auto bytes = stored.str();
+  bytes[bytes.size() - 1] ^= 0x10;
+
+  std::istringstream to_verify(bytes);
+  ASSERT_THROW(serialize::verify(to_verify), std::logic_error);
+
+  std::istringstream to_load(bytes);
+  UseLoad<Alphabet> caller(input);
+  ASSERT_THROW(serialize::load_reference<Alphabet>(to_load, Reference(reference.begin(), reference.end()), caller), std::logic_error);
+}
+
+TEST_F(ApiFormat, RejectsLegacyLayout)
+{
+  auto index = build();
+  std::stringstream stored;
+  auto save_id = [&] (size_t id) { serialize::Id(id).save(stored); };
+  serialize::InvokeId{}.call_type<Alphabet, impl::Bind<Parse, Alphabet>, impl::Bind<Literal, Alphabet>>(save_id);
+  index.serialize(stored);
+
+  UseLoad<Alphabet> caller(input);
+  ASSERT_THROW(serialize::load_reference<Alphabet>(stored, Reference(reference.begin(), reference.end()), caller), std::logic_error);
+}
+
+TEST_F(ApiFormat, RejectsOtherVersions)
+{
+  std::stringstream stored;
+  serialize::store(build(), stored);
+  auto bytes = stored.str();
+  bytes[sizeof(serialize::format::magic)] ^= 0x01;
+
+  std::istringstream to_load(bytes);
+  UseLoad<Alphabet> caller(input);
+  ASSERT_THROW(serialize::load_reference<Alphabet>(to_load, Reference(reference.begin(), reference.end()), caller), std::logic_error);
+}
+
+// A stream that cannot seek back to the header
+struct unseekable : std::stringbuf {
+  pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) override { return pos_type(-1); }
+  pos_type seekpos(pos_type, std::ios_base::openmode) override { return pos_type(-1); }
+};
+
+TEST_F(ApiFormat, StoreUnseekable)
+{
+  auto index = build();
+  std::stringstream seekable;
+  serialize::store(index, seekable);
+  unseekable buf;
+  std::ostream out(&buf);
+  serialize::store(index, out);
+  ASSERT_EQ(seekable.str(), buf.str());
+}
+
+TEST_F(ApiFormat, LoadFile)
+{
+  const char *index_file = "api_format_test.rlzap";
+  {
+    std::ofstream out(index_file, std::ios_base::binary | std::ios_base::trunc);
+    serialize::store(build(), out);
+  }
+  UseLoad<Alphabet> caller(input);
+  serialize::load_reference<Alphabet>(index_file, Reference(reference.begin(), reference.end()), caller);
+
+  // Corrupt the parse section, which is read by its own stream
+  {
+    std::fstream file(index_file, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+    auto hdr = serialize::verify(index_file);
+    std::streamoff pos = hdr.sections[0].offset + hdr.sections[0].length / 2;
+    file.seekg(pos);
+    auto byte = static_cast<char>(file.get() ^ 0x10);
+    file.seekp(pos);
+    file.put(byte);
+  }
+  ASSERT_THROW(serialize::verify(index_file), std::logic_error);
+  ASSERT_THROW(serialize::load_reference<Alphabet>(index_file, Reference(reference.begin(), reference.end()), caller), std::logic_error);
+  std::remove(index_file);
+}
@@ -0,0 +1,104 @@
+#include <vector>
+
+#include <autotune.hpp>
+#include <match.hpp>
+
+#include <gtest/gtest.h>
+#include "main.hpp"
+
+struct point {
+  int id;
+  rlz::tune::estimate est;
+};
+
+TEST(Autotune, Blocks)
+{
+  rlz::tune::parse_stats stats(2UL);    // Relative diffs in [-2, 1]
+  stats.copy(0UL, 100UL, 10UL);         // Delta 100: first block
+  stats.copy(10UL, 111UL, 10UL);        // Delta 101
+  stats.copy(20UL, 118UL, 10UL);        // Delta 98
+  stats.copy(30UL, 140UL, 10UL);        // Delta 110: new block
+  stats.copy(40UL, 148UL, 10UL);        // Delta 108
+  EXPECT_EQ(stats.blocks, 2UL);
+  EXPECT_EQ(stats.copies, 5UL);
+  EXPECT_EQ(stats.symbols, 50UL);
+  EXPECT_EQ(stats.literals, 0UL);
+}
+
+TEST(Autotune, Subphrases)
+{
+  rlz::tune::parse_stats stats(4UL);
+  stats.literal(0UL, 7UL);              // Opens a block with an empty copy
+  stats.copy(7UL, 7UL, 10UL);
+  stats.literal(17UL, 20UL);
+  stats.copy(37UL, 40UL, 5UL);
+  stats.literal(42UL, 3UL);
+  EXPECT_EQ(stats.blocks, 1UL);
+  EXPECT_EQ(stats.literals, 30UL);
+  EXPECT_EQ(stats.symbols, 45UL);
+
+  // Literal runs of at most 3: 3 subphrases for the bare run, 6 more after the first copy
+  EXPECT_EQ(stats.subphrases(2UL), 2UL + 3UL + 6UL);
+  // Of at most 15: 1 for the bare run, 1 more after the first copy
+  EXPECT_EQ(stats.subphrases(4UL), 2UL + 1UL + 1UL);
+  // Of at most 255: no extra subphrases
+  EXPECT_EQ(stats.subphrases(8UL), 2UL + 1UL);
+}
+
+TEST(Autotune, Cost)
+{
+  rlz::tune::parse_stats stats(4UL);
+  for (auto i = 0UL; i < 100UL; ++i) {
+    stats.copy(i * 20UL, i * 20UL + 7UL, 16UL);
+    stats.literal(i * 20UL + 16UL, 4UL);
+  }
+  auto narrow = rlz::tune::extraction_cost(stats, 2UL, 64UL, 64UL);
+  auto wide   = rlz::tune::extraction_cost(stats, 4UL, 64UL, 64UL);
+  EXPECT_GT(narrow, wide);                    // Split runs: more subphrases to decode
+  auto dense  = rlz::tune::extraction_cost(stats, 4UL, 16UL, 64UL);
+  EXPECT_LT(dense, wide);                     // Shorter prefix sums
+}
+
+TEST(Autotune, Windows)
+{
+  auto ws = rlz::tune::sample_windows(1000UL, 100UL, 4UL);
+  ASSERT_EQ(ws.size(), 4UL);
+  for (auto i = 0UL; i < ws.size(); ++i) {
+    EXPECT_EQ(ws[i].first, i * 250UL);
+    EXPECT_EQ(ws[i].second - ws[i].first, 25UL);
+  }
+  auto all = rlz::tune::sample_windows(50UL, 100UL);
+  ASSERT_EQ(all.size(), 1UL);
+  EXPECT_EQ(all[0].second, 50UL);
+
+  std::vector<rlz::match> ms;
+  for (auto i = 0UL; i < 10UL; ++i) {
+    ms.push_back(rlz::match { i, 10UL - i });
+  }
+  auto w = rlz::tune::window(ms.begin(), 2UL, 6UL);
+  ASSERT_EQ(w.size(), 4UL);
+  for (auto i = 0UL; i < w.size(); ++i) {
+    EXPECT_EQ(w[i].ptr, 2UL + i);
+    EXPECT_EQ(w[i].len, 4UL - i);
+  }
+}
+
+TEST(Autotune, Front)
+{
+  std::vector<point> points {{
+    point { 0, { 100.0, 9.0 } },
+    point { 1, { 104.0, 5.0 } },
+    point { 2, { 106.0, 6.0 } },    // Dominated by 1
+    point { 3, { 120.0, 2.0 } },
+    point { 4, { 100.0, 10.0 } },   // Dominated by 0
+  }};
+  auto front = rlz::tune::pareto_front(points);
+  ASSERT_EQ(front.size(), 3UL);
+  EXPECT_EQ(front[0].id, 0);
+  EXPECT_EQ(front[1].id, 1);
+  EXPECT_EQ(front[2].id, 3);
+
+  EXPECT_EQ(rlz::tune::choose(front, 0.0).id, 0);
+  EXPECT_EQ(rlz::tune::choose(front, 0.05).id, 1);
+  EXPECT_EQ(rlz::tune::choose(front, 0.5).id, 3);
+}
@@ -1,6 +1,7 @@
 #include <bit_vectors.hpp>
 #include <sdsl/bit_vectors.hpp>
 
+#include <random>
 #include <sstream>
 #include <tuple>
 #include <type_traits>
@@ -110,6 +111,7 @@ public:
 
 using rlz::vectors::sparse;
 using rlz::vectors::dense;
+using rlz::vectors::interleaved;
 using rlz::vectors::algorithms::rank;
 using rlz::vectors::algorithms::bitset;
 
@@ -121,7 +123,11 @@ using VectorTypes = ::testing::Types<
   config<rlz::vectors::BitVector<sparse, rank, rlz::vectors::algorithms::select, bitset>,  BitvectorFactory>,
   config<rlz::vectors::BitVector<dense,  rank, rlz::vectors::algorithms::select, bitset>,  BitvectorFactory>,
   config<rlz::vectors::BitVector<sparse, rank, rlz::vectors::algorithms::select, bitset>,  SerializeFactory>,
-  config<rlz::vectors::BitVector<dense,  rank, rlz::vectors::algorithms::select, bitset>,  SerializeFactory>
+  config<rlz::vectors::BitVector<dense,  rank, rlz::vectors::algorithms::select, bitset>,  SerializeFactory>,
+  config<rlz::vectors::BitVector<interleaved, rank, rlz::vectors::algorithms::select, bitset>,  BuilderFactory>,
+  config<rlz::vectors::BitVector<interleaved, rank, rlz::vectors::algorithms::select, bitset>,  TupleFactory>,
+  config<rlz::vectors::BitVector<interleaved, rank, rlz::vectors::algorithms::select, bitset>,  BitvectorFactory>,
+  config<rlz::vectors::BitVector<interleaved, rank, rlz::vectors::algorithms::select, bitset>,  SerializeFactory>
 >;
 TYPED_TEST_CASE(BitVector, VectorTypes);
 
@@ -197,4 +203,32 @@ TYPED_TEST(BitVector, BitsetPartial)
       ASSERT_EQ(boost::make_iterator_range(begin, end), boost::make_iterator_range(exp_beg, exp_end));
     }
   }
-}
\ No newline at end of file
+}
+
+TEST(Interleaved, MatchesDense)
+{
+  using Dense       = rlz::vectors::BitVector<dense, rank, rlz::vectors::algorithms::select>;
+  using Interleaved = rlz::vectors::BitVector<interleaved, rank, rlz::vectors::algorithms::select>;
+  std::default_random_engine rg;
+  for (auto density : { 0.001, 0.1, 0.5, 0.999 }) {
+    for (auto len : { 1UL, 511UL, 512UL, 513UL, 100000UL }) {
+      std::bernoulli_distribution bd(density);
+      std::vector<size_t> ones;
+      for (auto i = 0UL; i < len; ++i) {
+        if (bd(rg)) { ones.push_back(i); }
+      }
+      Dense       exp(ones.begin(), ones.end(), len);
+      Interleaved got(ones.begin(), ones.end(), len);
+      got = load_unload(got);
+      ASSERT_EQ(exp.size(), got.size());
+      for (auto i = 0UL; i < len; ++i) {
+        ASSERT_EQ(exp[i], got[i]);
+        ASSERT_EQ(exp.rank_1(i), got.rank_1(i));
+        ASSERT_EQ(exp.get_int(i, std::min<size_t>(64UL, len - i)), got.get_int(i, std::min<size_t>(64UL, len - i)));
+      }
+      for (auto i = 1UL; i <= ones.size(); ++i) {
+        ASSERT_EQ(exp.select_1(i), got.select_1(i));
+      }
+    }
+  }
+}
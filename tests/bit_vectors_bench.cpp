@@ -0,0 +1,76 @@
+#include <bit_vectors.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Random rank/select queries on the bit-vector representations usable in parse_keeper.
+// Usage: bit_vectors_bench [bits] [queries]
+
+using rlz::vectors::algorithms::rank;
+
+template <typename Bv, typename Fun>
+double ns_per_query(const Bv &bv, const std::vector<size_t> &queries, Fun f, size_t &checksum)
+{
+  using namespace std::chrono;
+  auto t_1 = high_resolution_clock::now();
+  for (auto q : queries) {
+    checksum += f(bv, q);
+  }
+  auto t_2 = high_resolution_clock::now();
+  return 1.0 * duration_cast<nanoseconds>(t_2 - t_1).count() / queries.size();
+}
+
+template <typename Rep>
+void bench(const std::string &name, const std::vector<size_t> &ones, size_t len, size_t n_queries, double density)
+{
+  using Bv = rlz::vectors::BitVector<Rep, rank, rlz::vectors::algorithms::select>;
+  Bv bv(ones.begin(), ones.end(), len);
+
+  std::default_random_engine rg(len);
+  std::uniform_int_distribution<size_t> pos(0UL, len - 1);
+  std::uniform_int_distribution<size_t> rnk(1UL, ones.size());
+  std::vector<size_t> rank_q(n_queries), select_q(n_queries);
+  for (auto &q : rank_q)   { q = pos(rg); }
+  for (auto &q : select_q) { q = rnk(rg); }
+
+  size_t checksum = 0UL;
+  auto rank_ns   = ns_per_query(bv, rank_q,   [] (const Bv &b, size_t i) { return b.rank_1(i); },   checksum);
+  auto select_ns = ns_per_query(bv, select_q, [] (const Bv &b, size_t i) { return b.select_1(i); }, checksum);
+
+  std::cout << std::setw(12) << name
+            << std::setw(10) << density
+            << std::setw(12) << std::fixed << std::setprecision(2) << rank_ns
+            << std::setw(12) << select_ns
+            << std::setw(14) << 8.0 * sdsl::size_in_bytes(bv) / len
+            << "  (" << checksum << ")" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t len       = argc > 1 ? std::stoull(argv[1]) : (1UL << 28);
+  size_t n_queries = argc > 2 ? std::stoull(argv[2]) : (1UL << 22);
+
+  std::cout << std::setw(12) << "rep"
+            << std::setw(10) << "density"
+            << std::setw(12) << "rank ns"
+            << std::setw(12) << "select ns"
+            << std::setw(14) << "bits/bit" << std::endl;
+  for (auto density : { 0.01, 0.1, 0.5 }) {
+    std::default_random_engine rg;
+    std::bernoulli_distribution bd(density);
+    std::vector<size_t> ones;
+    for (auto i = 0UL; i < len; ++i) {
+      if (bd(rg)) { ones.push_back(i); }
+    }
+    if (ones.empty()) { continue; }
+    bench<rlz::vectors::sparse>("sparse", ones, len, n_queries, density);
+    bench<rlz::vectors::dense>("dense", ones, len, n_queries, density);
+    bench<rlz::vectors::interleaved>("interleaved", ones, len, n_queries, density);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+#include <build_stats.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "main.hpp"
+
+using namespace rlz::instrument;
+
+class BuildStats : public ::testing::Test {
+public:
+  virtual void SetUp()    { registry::global().clear(); }
+  virtual void TearDown() { registry::global().enable(false); registry::global().clear(); }
+};
+
+TEST_F(BuildStats, DisabledByDefault)
+{
+  ASSERT_FALSE(registry::global().enabled());
+  {
+    scoped_stage s("sa", 100UL);
+  }
+  ASSERT_TRUE(registry::global().stages().empty());
+}
+
+TEST_F(BuildStats, Accumulate)
+{
+  registry::global().enable();
+  for (auto i = 0U; i < 3U; ++i) {
+    scoped_stage s("parse", 10UL);
+    std::vector<char> work(1UL << 20, 'a');
+    s.add_bytes(work.size());
+  }
+  {
+    scoped_stage s("encode");
+    s.stop();
+    s.add_bytes(1UL);   // Ignored once stopped
+  }
+  auto st = registry::global().stages();
+  ASSERT_EQ(2UL, st.size());
+  ASSERT_EQ("parse", st[0].name);
+  ASSERT_EQ(3UL, st[0].calls);
+  ASSERT_EQ(3UL * (10UL + (1UL << 20)), st[0].bytes);
+  ASSERT_GE(st[0].wall_ms, 0.0);
+  ASSERT_GT(st[0].peak_rss, 0UL);
+  ASSERT_EQ("encode", st[1].name);
+  ASSERT_EQ(0UL, st[1].bytes);
+
+  std::stringstream json;
+  registry::global().print_json(json);
+  ASSERT_NE(std::string::npos, json.str().find("\"name\": \"parse\""));
+}
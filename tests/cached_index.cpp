@@ -0,0 +1,90 @@
+#include <api.hpp>
+#include <cached_index.hpp>
+#include <parse_rlzap.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "main.hpp"
+
+using namespace rlz;
+
+class CachedIndex : public ::testing::Test {
+public:
+  using Alphabet  = alphabet::dna<>;
+  using Parse     = api::ParseKeeper<values::Size<32UL>, values::Size<4UL>>;
+  using Literal   = api::LiteralKeeper<prefix::sampling_cumulative<values::Size<4UL>, values::Size<64UL>>>;
+  using Reference = iterator_container<Alphabet, std::vector<char>::iterator>;
+  using Index     = impl::Index<Alphabet, container_wrapper<Alphabet, Reference>, Parse, Literal>;
+
+  std::vector<char> reference;
+  std::vector<char> input;
+  Index idx;
+
+  virtual void SetUp()
+  {
+    std::default_random_engine rg(42U);
+    std::uniform_int_distribution<int> base(0, 3);
+    std::uniform_int_distribution<size_t> pos(0U, 9000U);
+    for (auto i = 0U; i < 10000U; ++i) {
+      reference.push_back("ACGT"[base(rg)]);
+    }
+    while (input.size() < 50000U) {
+      auto p = pos(rg);
+      input.insert(input.end(), reference.begin() + p, reference.begin() + p + 500U);
+      input.push_back("ACGT"[base(rg)]);
+    }
+    idx = construct_iterator<Alphabet, Parse, Literal>(
+      input.begin(), input.end(), Reference(reference.begin(), reference.end()), parser_rlzap{}
+    );
+  }
+};
+
+TEST_F(CachedIndex, Extract)
+{
+  cached_index<Index> cached(idx, 256UL, 16UL * 256UL, 4UL, 2UL);
+  ASSERT_EQ(input.size(), cached.size());
+
+  std::default_random_engine rg(7U);
+  std::uniform_int_distribution<size_t> pos(0U, input.size() - 1);
+  std::uniform_int_distribution<size_t> len(0U, 2000U);
+  for (auto i = 0U; i < 2000U; ++i) {
+    auto begin = pos(rg);
+    auto end   = std::min(input.size(), begin + len(rg));
+    auto got   = cached(begin, end);
+    ASSERT_TRUE(std::equal(got.begin(), got.end(), input.begin() + begin));
+    ASSERT_EQ(input[begin], cached(begin));
+  }
+  auto s = cached.stats();
+  ASSERT_GT(s.misses, 0UL);
+  ASSERT_GT(s.evictions, 0UL);
+}
+
+TEST_F(CachedIndex, HotBlocksHit)
+{
+  cached_index<Index> cached(idx, 1024UL, 64UL * 1024UL);
+  std::vector<char> buffer(100UL);
+  for (auto round = 0U; round < 10U; ++round) {
+    cached(5000UL, 5100UL, buffer.begin());
+    ASSERT_TRUE(std::equal(buffer.begin(), buffer.end(), input.begin() + 5000UL));
+  }
+  auto s = cached.stats();
+  ASSERT_EQ(1UL, s.misses);
+  ASSERT_EQ(9UL, s.hits);
+}
+
+TEST_F(CachedIndex, BudgetBelowShards)
+{
+  // Room for 2 blocks with the default 16 shards: the budget, not the shards, bounds the cache
+  cached_index<Index> cached(idx, 256UL, 2UL * 256UL);
+  std::vector<char> buffer(256UL);
+  for (auto b = 0UL; b < 8UL; ++b) {
+    cached(b * 256UL, (b + 1) * 256UL, buffer.begin());
+    ASSERT_TRUE(std::equal(buffer.begin(), buffer.end(), input.begin() + b * 256UL));
+  }
+  auto s = cached.stats();
+  ASSERT_EQ(8UL, s.misses);
+  ASSERT_LE(s.misses - s.evictions, 2UL);
+}
@@ -170,3 +170,40 @@ TYPED_TEST(Coordinator, EndsWithLiteral)
     "{[C(0,0,3)][C(3,3,6)L(8)][L(8)][L(4)]}{[C(29,5,6)][C(35,8,6)][C(41,13,3)]}{[C(44,100,10)][C(54,110,10)L(8)][L(4)]}.";
   ASSERT_EQ(expected, computed);
 }
+
+TEST(Coordinator, PhraseBounds)
+{
+  using Alphabet = rlz::alphabet::dna<>;
+  using SymbolIt = const char*;
+  auto ss = std::make_shared<std::stringstream>();
+  std::vector<std::shared_ptr<rlz::build::observer<Alphabet, SymbolIt>>> components {
+    std::make_shared<rlz::build::phrase_limit<Alphabet, SymbolIt>>(rlz::build::phrase_bounds(7UL, 16UL)),
+    std::make_shared<observer<Alphabet, SymbolIt>>(ss)
+  };
+  std::vector<char> buffer(100);
+  rlz::build::coordinator<Alphabet, SymbolIt> c(components.begin(), components.end(), buffer.data());
+  c.copy_evt(0, 100, 10);
+  c.literal_evt(10, 12);
+  c.copy_evt(22, 50, 20);
+  c.end_evt();
+  std::string expected =
+    "{[C(0,100,7)][C(7,107,3)L(4)][L(2)]}{[L(6)][C(22,50,7)][C(29,57,3)]}{[C(32,60,7)][C(39,67,3)]}.";
+  ASSERT_EQ(expected, ss->str());
+}
+
+TEST(Coordinator, PhraseBoundsOrigin)
+{
+  using Alphabet = rlz::alphabet::dna<>;
+  using SymbolIt = const char*;
+  auto ss = std::make_shared<std::stringstream>();
+  // Parse of the input from position 10: the first block boundary is at 16, 6 symbols in
+  std::vector<std::shared_ptr<rlz::build::observer<Alphabet, SymbolIt>>> components {
+    std::make_shared<rlz::build::phrase_limit<Alphabet, SymbolIt>>(rlz::build::phrase_bounds(0UL, 16UL).at(10UL)),
+    std::make_shared<observer<Alphabet, SymbolIt>>(ss)
+  };
+  std::vector<char> buffer(100);
+  rlz::build::coordinator<Alphabet, SymbolIt> c(components.begin(), components.end(), buffer.data());
+  c.copy_evt(0, 100, 20);
+  c.end_evt();
+  ASSERT_EQ("[C(0,100,6)]{[C(6,106,14)]}.", ss->str());
+}
@@ -2,6 +2,7 @@
 #include "serialize.hpp"
 
 #include <algorithm>
+#include <random>
 #include <vector>
 
 #include <bit_vectors.hpp>
@@ -55,7 +56,9 @@ using CumulTypes = ::testing::Types<
   rlz::prefix::cumulative<rlz::vectors::sparse>,
   rlz::prefix::cumulative<rlz::vectors::dense>,
   rlz::prefix::sampling_cumulative<>,
-  rlz::prefix::sampling_cumulative<rlz::values::Size<4U>, rlz::values::Size<16U>, rlz::values::Size<16U>>
+  rlz::prefix::sampling_cumulative<rlz::values::Size<4U>, rlz::values::Size<16U>, rlz::values::Size<16U>>,
+  rlz::prefix::sampling_cumulative<rlz::values::Size<2U>, rlz::values::Size<64U>>,
+  rlz::prefix::sampling_cumulative<rlz::values::Size<8U>, rlz::values::Size<64U>>
 >;
 TYPED_TEST_CASE(Cumulative, CumulTypes);
 
@@ -157,3 +160,57 @@ TYPED_TEST(Cumulative, SerialIteratorSub)
     }
   }
 }
+
+TYPED_TEST(Cumulative, BuilderAccess)
+{
+  typename TypeParam::builder build;
+  for (auto i : this->v) {
+    build.push_back(i);
+  }
+  auto cum = build.get();
+  for (auto i = 0U; i < this->v.size(); ++i) {
+    ASSERT_EQ(this->v[i], cum.access(i));
+  }
+}
+
+TYPED_TEST(Cumulative, BuilderPrefix)
+{
+  typename TypeParam::builder build;
+  for (auto i : this->v) {
+    build.push_back(i);
+  }
+  auto cum = load_unload(build.get());
+  for (auto i = 0U; i < this->prefix.size(); ++i) {
+    ASSERT_EQ(this->prefix[i], cum.prefix(i));
+  }
+}
+
+template <typename Sampling>
+void check_word_sum(size_t elements, size_t seed)
+{
+  std::default_random_engine rg(seed);
+  std::uniform_int_distribution<size_t> rd(0U, Sampling::max_length);
+  std::vector<size_t> v(elements);
+  for (auto &i : v) { i = rd(rg); }
+  Sampling cum(v.begin(), v.end());
+  size_t expected = 0U;
+  for (auto i = 0U; i < v.size(); ++i) {
+    expected += v[i];
+    ASSERT_EQ(expected, cum.prefix(i));
+    ASSERT_EQ(cum.prefix_bytewise(i), cum.prefix(i));
+  }
+}
+
+TEST(SamplingCumulative, WordSumEquivalence)
+{
+  using namespace rlz::values;
+  for (auto elements : { 1U, 7U, 63U, 64U, 65U, 1000U, 4097U }) {
+    check_word_sum<rlz::prefix::sampling_cumulative<Size<1U>, Size<64U>>>(elements, elements);
+    check_word_sum<rlz::prefix::sampling_cumulative<Size<2U>, Size<16U>>>(elements, elements);
+    check_word_sum<rlz::prefix::sampling_cumulative<Size<2U>, Size<128U>>>(elements, elements);
+    check_word_sum<rlz::prefix::sampling_cumulative<Size<4U>, Size<32U>>>(elements, elements);
+    check_word_sum<rlz::prefix::sampling_cumulative<Size<4U>, Size<64U>>>(elements, elements);
+    check_word_sum<rlz::prefix::sampling_cumulative<Size<8U>, Size<48U>>>(elements, elements);
+    check_word_sum<rlz::prefix::sampling_cumulative<Size<8U>, Size<64U>, Size<32U>>>(elements, elements);
+  }
+}
@@ -3,6 +3,7 @@
 #include <alphabet.hpp>
 #include <dumper.hpp>
 #include <get_matchings.hpp>
+#include <reference_matcher.hpp>
 
 #include "main.hpp"
 
@@ -144,3 +145,28 @@ TYPED_TEST(GetMatchings, Matches)
     }
   }
 }
+
+TYPED_TEST(GetMatchings, ReferenceMatcher)
+{
+  using Alphabet = TypeParam;
+  auto matches       = std::get<0>(this->get());
+  auto input_vec     = this->get_input();
+  auto reference_vec = this->get_reference();
+
+  // Round-trip through storage, as the matcher is meant to be kept alongside the reference
+  std::stringstream stored;
+  reference_matcher<Alphabet>(reference_vec.begin(), reference_vec.end()).serialize(stored);
+  reference_matcher<Alphabet> matcher;
+  matcher.load(stored);
+  ASSERT_EQ(reference_vec.size(), matcher.reference_size());
+
+  auto got = matcher(reference_vec.begin(), input_vec.begin(), input_vec.size());
+  ASSERT_EQ(matches.size(), got.size());
+  for (auto i = 0U; i < got.size(); ++i) {
+    ASSERT_EQ(matches[i].len, got[i].len);
+    ASSERT_LE(got[i].ptr + got[i].len, reference_vec.size());
+    for (auto l = 0U; l < got[i].len; ++l) {
+      ASSERT_EQ(reference_vec[got[i].ptr + l], input_vec[i + l]);
+    }
+  }
+}
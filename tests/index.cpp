@@ -188,6 +188,12 @@ using IndexTypes = ::testing::Types<
     parse_keeper<rlz::alphabet::lcp_32, values::Size<16>, values::Size<4>, vectors::sparse, vectors::dense>,
     literal_split_keeper<rlz::alphabet::lcp_32, rlz::prefix::sampling_cumulative<>>
   >,
+  impl::type_list<
+    rlz::alphabet::lcp_32,
+    string_adapt<rlz::alphabet::lcp_32>,
+    parse_keeper<rlz::alphabet::lcp_32, values::Size<16>, values::Size<4>, vectors::interleaved, vectors::interleaved>,
+    literal_split_keeper<rlz::alphabet::lcp_32, rlz::prefix::sampling_cumulative<>>
+  >,
 
   impl::type_list<
     rlz::alphabet::Integer<16UL>,
@@ -273,6 +279,12 @@ using IndexTypes = ::testing::Types<
     string_adapt<rlz::alphabet::dna<>>,
     parse_keeper<rlz::alphabet::dna<>, values::Size<16>, values::Size<4>, vectors::sparse, vectors::dense>,
     literal_split_keeper<rlz::alphabet::dna<>, rlz::prefix::sampling_cumulative<>>
+  >,
+  impl::type_list<
+    rlz::alphabet::dna<>,
+    string_adapt<rlz::alphabet::dna<>>,
+    parse_keeper<rlz::alphabet::dna<>, values::Size<16>, values::Size<4>, vectors::interleaved, vectors::interleaved>,
+    literal_split_keeper<rlz::alphabet::dna<>, rlz::prefix::sampling_cumulative<>>
   >
 
 >;
@@ -455,4 +467,93 @@ TYPED_TEST(Index, SerialRangeAccess)
 }
 
 
+TYPED_TEST(Index, Cursor)
+{
+  using Alphabet = typename unpack<TypeParam>::Alphabet;
+  using Symbol   = typename Alphabet::Symbol;
+  auto source    = this->source_get();
+  std::vector<Symbol> storage(source.size());
+
+  for (auto max_scan : { 0UL, 8UL, 4096UL }) {
+    // Sliding windows (forward seeks), then every position backwards (repositioning)
+    auto cur = this->index.get_cursor(max_scan);
+    for (auto len = 1U; len <= 16U; len += 5U) {
+      for (auto start = 0U; start + len <= source.size(); ++start) {
+        cur(start, start + len, storage.begin());
+        ASSERT_TRUE(std::equal(storage.begin(), std::next(storage.begin(), len), std::next(source.begin(), start)))
+          << "Failure on window " << start << ", length " << len << ", max_scan " << max_scan;
+      }
+    }
+    for (auto i = source.size(); i-- > 0; ) {
+      ASSERT_EQ(source[i], cur(i)) << "Failure on position " << i << ", max_scan " << max_scan;
+    }
+    cur(0U, source.size(), storage.begin());
+    ASSERT_TRUE(check_eq(source, storage));
+  }
+}
+
+TYPED_TEST(Index, Segments)
+{
+  using Alphabet = typename unpack<TypeParam>::Alphabet;
+  using Symbol   = typename Alphabet::Symbol;
+  auto source    = this->source_get();
+
+  for (auto start = 0U; start < source.size(); start += 3U) {
+    for (auto end = start + 1; end <= source.size(); end += 7U) {
+      std::vector<Symbol> got;
+      this->index.segments(start, end, [&] (const Symbol *span, size_t len) {
+        ASSERT_GT(len, 0UL);
+        got.insert(got.end(), span, span + len);
+      });
+      ASSERT_TRUE(check_eq(
+        std::next(source.begin(), start),
+        std::next(source.begin(), end),
+        got.begin(),
+        got.end()
+      )) << "Failure on range " << start << ", " << end;
+    }
+  }
+}
+
+TYPED_TEST(Index, SegmentsNonEmpty)
+{
+  using Alphabet = typename unpack<TypeParam>::Alphabet;
+  using Symbol   = typename Alphabet::Symbol;
+  auto size      = this->source_get().size();
+
+  // Every range, so that ranges ending on subphrases without literals are covered
+  size_t empty = 0UL, spans = 0UL;
+  for (auto start = 0UL; start < size; ++start) {
+    for (auto end = start + 1UL; end <= size; ++end) {
+      this->index.segments(start, end, [&] (const Symbol *, size_t len) {
+        empty += (len == 0UL);
+        ++spans;
+      });
+    }
+  }
+  EXPECT_GT(spans, 0UL);
+  EXPECT_EQ(0UL, empty);
+}
+
+TYPED_TEST(Index, Iterator)
+{
+  using Alphabet = typename unpack<TypeParam>::Alphabet;
+  using Symbol   = typename Alphabet::Symbol;
+  auto source    = this->source_get();
+
+  ASSERT_EQ(source.size(), static_cast<size_t>(std::distance(this->index.begin(), this->index.end())));
+  std::vector<Symbol> got(this->index.begin(), this->index.end());
+  ASSERT_TRUE(check_eq(source, got));
+  ASSERT_TRUE(std::equal(source.begin(), source.end(), this->index.begin()));
+
+  // Iterators are independent copies
+  auto it = this->index.begin();
+  for (auto i = 0U; i < source.size(); ++i) {
+    auto copy = it;
+    ++it;
+    ASSERT_EQ(source[i], *copy) << "Failure on position " << i;
+  }
+  ASSERT_TRUE(it == this->index.end());
+}
+
 }}
@@ -0,0 +1,196 @@
+#include <alphabet.hpp>
+#include <api.hpp>
+#include <containers.hpp>
+#include <dumper.hpp>
+#include <get_matchings.hpp>
+#include <index_append.hpp>
+#include <index_merge.hpp>
+#include <parse_rlzap.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "main.hpp"
+
+using namespace rlz;
+
+using Alphabet = alphabet::dna<>;
+using Parse    = api::ParseKeeper<values::Size<32UL>, values::Size<4UL>>;
+using Literal  = api::LiteralKeeper<prefix::sampling_cumulative<values::Size<4UL>, values::Size<64UL>>>;
+using Iterator = std::vector<char>::iterator;
+using Source   = iterator_container<Alphabet, Iterator>;
+using Index    = impl::Index<Alphabet, container_wrapper<Alphabet, Source>, Parse, Literal>;
+
+class IndexMerge : public ::testing::Test {
+public:
+  std::vector<char> reference;
+  std::vector<char> input;
+
+  void SetUp() override
+  {
+    std::default_random_engine rg(42);
+    std::uniform_int_distribution<int> base(0, 3);
+    std::bernoulli_distribution mutate(0.02);
+    const char bases[] = { 'A', 'C', 'G', 'T' };
+    reference.resize(3000UL);
+    for (auto &s : reference) {
+      s = bases[base(rg)];
+    }
+    for (auto c = 0UL; c < 4UL; ++c) {
+      for (auto s : reference) {
+        input.push_back(mutate(rg) ? bases[base(rg)] : s);
+      }
+    }
+  }
+
+  // Index of input[b, e) alone
+  Index part(size_t b, size_t e, build::phrase_bounds bounds = build::phrase_bounds())
+  {
+    auto ref_dump   = utils::get_iterator_dumper(reference.begin(), reference.end());
+    auto input_dump = utils::get_iterator_dumper(std::next(input.begin(), b), std::next(input.begin(), e));
+    auto matches    = std::get<0>(get_relative_matches<Alphabet>(ref_dump, input_dump));
+    return construct_ptr<Alphabet, Parse, Literal>(
+      input.data() + b, Source(reference.begin(), reference.end()), parser_rlzap{4UL, 32UL, 2UL},
+      matches.begin(), matches.end(), bounds
+    );
+  }
+
+  // Starts of the subphrases of idx that start a block
+  static std::vector<size_t> block_starts(const Index &idx)
+  {
+    std::vector<size_t> to_ret;
+    auto start = 0UL;
+    auto visit = [&] (std::int64_t, size_t phrase_len, size_t, Index::LiteralIterator, bool block) {
+      if (block) {
+        to_ret.push_back(start);
+      }
+      start += phrase_len;
+    };
+    idx.process_subphrases(visit);
+    return to_ret;
+  }
+};
+
+TEST_F(IndexMerge, Concatenates)
+{
+  std::vector<size_t> cuts {{ 0UL, 1000UL, 1001UL, 5555UL, input.size() }};
+  std::vector<Index> parts;
+  for (auto i = 1UL; i < cuts.size(); ++i) {
+    parts.push_back(part(cuts[i - 1], cuts[i]));
+  }
+  auto merged = merge(parts.begin(), parts.end());
+  ASSERT_EQ(merged.size(), input.size());
+  auto output = merged(0UL, merged.size());
+  ASSERT_EQ(output.size(), input.size());
+  EXPECT_TRUE(std::equal(input.begin(), input.end(), output.begin()));
+
+  // Random access across the seams
+  for (auto i = 990UL; i < 1010UL; ++i) {
+    EXPECT_EQ(merged(i), input[i]);
+  }
+  for (auto i = 5550UL; i < 5560UL; ++i) {
+    EXPECT_EQ(merged(i), input[i]);
+  }
+}
+
+TEST_F(IndexMerge, KeepsForcedBlocks)
+{
+  const size_t block_len = 256UL;
+  std::vector<size_t> cuts {{ 0UL, 1024UL, 5120UL, input.size() }};
+  std::vector<Index> parts;
+  for (auto i = 1UL; i < cuts.size(); ++i) {
+    parts.push_back(part(cuts[i - 1], cuts[i], build::phrase_bounds(0UL, block_len)));
+  }
+  auto merged = merge(parts.begin(), parts.end());
+  auto output = merged(0UL, merged.size());
+  ASSERT_TRUE(std::equal(input.begin(), input.end(), output.begin()));
+
+  auto blocks = block_starts(merged);
+  for (auto p = 0UL; p < input.size(); p += block_len) {
+    EXPECT_TRUE(std::binary_search(blocks.begin(), blocks.end(), p)) << "No block at " << p;
+  }
+}
+
+TEST_F(IndexMerge, RejectsOtherReference)
+{
+  auto first = part(0UL, 7000UL), second = part(7000UL, input.size());
+  std::stringstream stored;
+  serialize::store(second, stored);
+  Index loaded;
+  loaded.set_source(container_wrapper<Alphabet, Source>(Source(reference.begin(), std::next(reference.begin(), 100UL))));
+  EXPECT_THROW(serialize::load_into(stored, loaded), std::logic_error);
+
+  // Copies past the end of the reference of the merged index
+  index_merger<Index> merger(container_wrapper<Alphabet, Source>(Source(reference.begin(), std::next(reference.begin(), 100UL))));
+  EXPECT_THROW(merger.append(first), std::logic_error);
+}
+
+TEST_F(IndexMerge, StoreLoad)
+{
+  auto first = part(0UL, 7000UL), second = part(7000UL, input.size());
+  std::stringstream stored;
+  serialize::store(second, stored);
+  Index loaded;
+  serialize::load_into(stored, loaded);
+  loaded.set_source(second.get_source());
+
+  index_merger<Index> merger;
+  merger.append(first);
+  merger.append(loaded);
+  EXPECT_EQ(merger.size(), input.size());
+  auto merged = merger.get();
+  auto output = merged(0UL, merged.size());
+  EXPECT_TRUE(std::equal(input.begin(), input.end(), output.begin()));
+  EXPECT_THROW(merger.get(), std::logic_error);
+}
+
+TEST_F(IndexMerge, Append)
+{
+  reference_matcher<Alphabet> matcher(reference.begin(), reference.end());
+  auto idx = part(0UL, 2500UL);
+  std::vector<size_t> cuts {{ 2500UL, 2501UL, 6000UL, input.size() }};
+  for (auto i = 1UL; i < cuts.size(); ++i) {
+    // Parsing restarts inside idx: the copies after the restart are replayed at an offset
+    auto restart = last_subphrase(idx);
+    ASSERT_LT(0UL, restart);
+    append(idx, matcher, parser_rlzap{4UL, 32UL, 2UL}, std::next(input.begin(), cuts[i - 1]), std::next(input.begin(), cuts[i]));
+    ASSERT_EQ(cuts[i], idx.size());
+    auto output = idx(0UL, idx.size());
+    ASSERT_TRUE(std::equal(output.begin(), output.end(), input.begin()));
+    // Random access across the restart
+    auto from = restart - std::min(restart, 50UL), to = std::min(idx.size(), restart + 50UL);
+    auto seam = idx(from, to);
+    ASSERT_TRUE(std::equal(seam.begin(), seam.end(), std::next(input.begin(), from)));
+  }
+
+  // Close to a build on the whole input
+  auto whole = part(0UL, input.size());
+  EXPECT_LE(sdsl::size_in_bytes(idx), sdsl::size_in_bytes(whole) * 11UL / 10UL);
+
+  reference_matcher<Alphabet> other(reference.begin(), std::next(reference.begin(), 100UL));
+  EXPECT_THROW(append(idx, other, parser_rlzap{}, input.begin(), input.end()), std::logic_error);
+}
+
+TEST_F(IndexMerge, AppendBounds)
+{
+  const build::phrase_bounds bounds(64UL, 256UL);
+  reference_matcher<Alphabet> matcher(reference.begin(), reference.end());
+  auto idx = part(0UL, 1000UL, bounds);
+  std::vector<size_t> cuts {{ 1000UL, 1777UL, 5003UL, input.size() }};
+  for (auto i = 1UL; i < cuts.size(); ++i) {
+    ASSERT_LT(0UL, last_subphrase(idx));
+    append(idx, matcher, parser_rlzap{4UL, 32UL, 2UL}, std::next(input.begin(), cuts[i - 1]), std::next(input.begin(), cuts[i]), bounds);
+    auto output = idx(0UL, idx.size());
+    ASSERT_TRUE(std::equal(output.begin(), output.end(), input.begin()));
+  }
+  ASSERT_EQ(input.size(), idx.size());
+
+  // Blocks at the multiples of the block length of the whole input, not of the appended parts
+  auto blocks = block_starts(idx);
+  for (auto p = 0UL; p < input.size(); p += bounds.block_len) {
+    EXPECT_TRUE(std::binary_search(blocks.begin(), blocks.end(), p)) << "No block at " << p;
+  }
+}
@@ -95,6 +95,17 @@ struct serialize {
   }
 };
 
+struct build {
+  template <typename Symbol>
+  rlz::lcp_pack<Symbol> get()
+  {
+    auto v = junk_hold<Symbol>::get();
+    typename rlz::lcp_pack<Symbol>::builder b;
+    b.append(v.begin(), v.end());
+    return b.get();
+  }
+};
+
 template <typename Symbol, typename Get>
 struct param {
   using Size   = Symbol;
@@ -128,7 +139,10 @@ using Types = ::testing::Types<
   param<std::uint32_t, instantiate>,
   param<std::int16_t, serialize>,
   param<std::int32_t, serialize>,
-  param<std::uint32_t, serialize>
+  param<std::uint32_t, serialize>,
+  param<std::int16_t, build>,
+  param<std::int32_t, build>,
+  param<std::uint32_t, build>
 >;
 
 TYPED_TEST_CASE(lcp_packer, Types);
@@ -183,3 +197,47 @@ TYPED_TEST(lcp_packer, IteratorSkip)
 	}
   }
 }
+
+TYPED_TEST(lcp_packer, CopyAccess)
+{
+  auto junk = this->get_junk();
+  decltype(this->get()) pack;
+  {
+    auto original = this->get();
+    pack = original;
+  }
+  for (auto i = 0U; i < junk.size(); ++i) {
+	ASSERT_EQ(junk[i], pack[i]);
+  }
+}
+
+TEST(lcp_pack_dense, ManyExceptions)
+{
+  std::vector<std::int32_t> junk;
+  for (auto i = 0; i < 100000; ++i) {
+    junk.push_back((i % 3 == 0) ? i : -(i % 100));
+  }
+  rlz::lcp_pack<std::int32_t> pack(junk.begin(), junk.end());
+  for (auto i = 0U; i < junk.size(); ++i) {
+	ASSERT_EQ(junk[i], pack[i]);
+  }
+}
+
+TEST(lcp_pack_dense, NoExceptions)
+{
+  std::vector<std::int32_t> junk;
+  for (auto i = 0; i < 100000; ++i) {
+    junk.push_back((i % 200) - 100);
+  }
+  rlz::lcp_pack<std::int32_t> pack(junk.begin(), junk.end());
+  std::stringstream stored;
+  auto bytes = pack.serialize(stored);
+  // One byte per entry: no exception marker nor rank support
+  ASSERT_LT(bytes, junk.size() + junk.size() / 16U);
+
+  rlz::lcp_pack<std::int32_t> loaded;
+  loaded.load(stored);
+  for (auto i = 0U; i < junk.size(); ++i) {
+	ASSERT_EQ(junk[i], loaded[i]);
+  }
+}
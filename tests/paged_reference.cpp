@@ -0,0 +1,112 @@
+#include <api.hpp>
+#include <paged_container.hpp>
+#include <parse_rlzap.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "main.hpp"
+
+using namespace rlz;
+
+struct check_decompress {
+  const std::vector<char> *input;
+  bool equal;
+
+  template <typename Index>
+  void invoke(Index &idx)
+  {
+    auto got = idx(0UL, idx.size());
+    equal = got.size() == input->size() and std::equal(got.begin(), got.end(), input->begin());
+  }
+};
+
+class PagedReference : public ::testing::Test {
+public:
+  using Alphabet  = alphabet::dna<>;
+  using Parse     = api::ParseKeeper<values::Size<32UL>, values::Size<4UL>>;
+  using Literal   = api::LiteralKeeper<prefix::sampling_cumulative<values::Size<4UL>, values::Size<64UL>>>;
+
+  const char *ref_file = "paged_reference_test.bin";
+  std::vector<char> reference;
+  std::vector<char> input;
+
+  virtual void SetUp()
+  {
+    std::default_random_engine rg(42U);
+    std::uniform_int_distribution<int> base(0, 3);
+    std::uniform_int_distribution<size_t> pos(0U, 90000U);
+    for (auto i = 0U; i < 100000U; ++i) {
+      reference.push_back("ACGT"[base(rg)]);
+    }
+    while (input.size() < 200000U) {
+      auto p = pos(rg);
+      input.insert(input.end(), reference.begin() + p, reference.begin() + p + 1000U);
+      input.push_back("ACGT"[base(rg)]);
+    }
+    std::ofstream out(ref_file, std::ios_base::binary | std::ios_base::trunc);
+    out.write(reference.data(), reference.size());
+  }
+
+  virtual void TearDown()
+  {
+    std::remove(ref_file);
+  }
+};
+
+TEST_F(PagedReference, Access)
+{
+  paged_reference<Alphabet> paged(ref_file, 4UL * 4096UL, 4096UL);
+  ASSERT_EQ(reference.size(), paged.size());
+  ASSERT_TRUE(std::equal(paged.begin(), paged.end(), reference.begin()));
+
+  std::default_random_engine rg(7U);
+  std::uniform_int_distribution<size_t> pos(0U, reference.size() - 1);
+  for (auto i = 0U; i < 10000U; ++i) {
+    auto p = pos(rg);
+    ASSERT_EQ(reference[p], paged[p]);
+  }
+  auto s = paged.stats();
+  ASSERT_GT(s.misses, 0UL);
+  ASSERT_GT(s.evictions, 0UL);
+}
+
+TEST_F(PagedReference, Budget)
+{
+  for (auto budget : { 4096UL, 4UL * 4096UL, 5UL * 4096UL + 100UL, 40UL * 4096UL }) {
+    paged_reference<Alphabet> paged(ref_file, budget, 4096UL);
+    EXPECT_LE(paged.cache_bytes(), budget);
+    EXPECT_TRUE(std::equal(paged.begin(), paged.end(), reference.begin()));
+  }
+  EXPECT_THROW(paged_reference<Alphabet>(ref_file, 4095UL, 4096UL), std::logic_error);
+
+  paging::page_file file(ref_file, 4096UL, 4UL * 4096UL);
+  auto pages = (file.size() + 4095UL) / 4096UL;
+  EXPECT_NO_THROW(file.get(pages - 1UL));
+  EXPECT_THROW(file.get(pages), std::out_of_range);
+}
+
+TEST_F(PagedReference, LoadPaged)
+{
+  auto index = construct_iterator<Alphabet, Parse, Literal>(
+    input.begin(), input.end(),
+    iterator_container<Alphabet, std::vector<char>::iterator>(reference.begin(), reference.end()),
+    parser_rlzap{}
+  );
+  const char *index_file = "paged_reference_test.rlzap";
+  {
+    std::ofstream out(index_file, std::ios_base::binary | std::ios_base::trunc);
+    serialize::store(index, out);
+  }
+
+  check_decompress c { &input, false };
+  serialize::load_paged(index_file, ref_file, 8UL * 4096UL, c, 4096UL);
+  std::remove(index_file);
+  ASSERT_TRUE(c.equal);
+}
@@ -298,6 +298,23 @@ TYPED_TEST(ParseKeep, StartSubphrase)
   ASSERT_EQ(150, pk.start_subphrase(6)); 
 }
 
+TYPED_TEST(ParseKeep, NextSubphraseStart)
+{
+  using Alphabet = TypeParam;
+  using Symbol   = typename Alphabet::Symbol;
+  using namespace rlz;
+
+  std::vector<std::shared_ptr<build::observer<Alphabet, const typename Alphabet::Symbol*>>> observers;
+  std::vector<Symbol> buffer(150);
+
+  auto pk = this->get(observers, buffer.data());
+
+  for (auto i = 0U; i < 150U; ++i) {
+    auto sub = pk.subphrase(i);
+    ASSERT_EQ(pk.start_subphrase(sub + 1), pk.next_subphrase_start(i, sub)) << "Failure on position " << i;
+  }
+}
+
 TYPED_TEST(ParseKeep, Length)
 {
   using Alphabet = TypeParam;
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <parse_rlzap.hpp>
+#include <parse_rlzap_optimal.hpp>
+#include <match.hpp>
+
+#include <gtest/gtest.h>
+#include "main.hpp"
+
+using Parser = rlz::parser_rlzap_optimal<>;
+
+// Copies are (position, ptr, len), literal runs (position, 0, len)
+using event = std::tuple<size_t, size_t, size_t, bool>;
+
+template <typename P>
+std::vector<event> run(const P &parser, std::vector<rlz::match> &ms)
+{
+  std::vector<event> events;
+  parser(
+    ms.begin(), ms.end(), 0UL,
+    [&] (size_t pos, size_t len) { events.emplace_back(pos, 0UL, len, false); },
+    [&] (size_t pos, size_t ptr, size_t len) { events.emplace_back(pos, ptr, len, true); },
+    [] () { }
+  );
+  return events;
+}
+
+// Cost of a parse under the optimal parser's model
+double cost(const Parser &p, const std::vector<event> &events, std::vector<rlz::match> &ms)
+{
+  auto avg    = Parser::expected_phrase_length(ms.begin(), ms.end());
+  auto anchor = Parser::no_anchor;
+  double sum  = 0.0;
+  for (auto &e : events) {
+    if (std::get<3>(e)) {
+      auto delta    = static_cast<std::int64_t>(std::get<1>(e)) - static_cast<std::int64_t>(std::get<0>(e));
+      auto relative = p.is_relative(anchor, delta);
+      anchor = relative ? anchor : delta;
+      sum += p.cost_model().copy(relative, avg);
+    } else {
+      sum += std::get<2>(e) * p.cost_model().literal(avg);
+    }
+  }
+  return sum;
+}
+
+// Brute-force matching statistics of a mutated copy of a random reference
+std::vector<rlz::match> random_ms(size_t ref_len, size_t in_len, double mutation, size_t seed)
+{
+  std::default_random_engine rg(seed);
+  std::uniform_int_distribution<int> base(0, 3);
+  std::bernoulli_distribution mutate(mutation);
+  std::string ref(ref_len, 'A'), in;
+  for (auto &c : ref) { c = "ACGT"[base(rg)]; }
+  while (in.size() < in_len) {
+    for (auto c : ref) { in.push_back(mutate(rg) ? "ACGT"[base(rg)] : c); }
+  }
+  in.resize(in_len);
+
+  std::vector<rlz::match> ms(in_len);
+  for (auto i = 0UL; i < in_len; ++i) {
+    for (auto j = 0UL; j < ref_len; ++j) {
+      auto l = 0UL;
+      while (i + l < in_len and j + l < ref_len and in[i + l] == ref[j + l]) { ++l; }
+      if (l > ms[i].len) { ms[i] = rlz::match { j, l }; }
+    }
+  }
+  return ms;
+}
+
+TEST(RlzapOptimalParse, Covers)
+{
+  auto ms     = random_ms(300UL, 1500UL, 0.02, 1UL);
+  auto events = run(Parser{4UL, rlz::optimal::bit_cost{4UL, 32UL, 2UL, 4UL}}, ms);
+  size_t pos  = 0UL;
+  for (auto &e : events) {
+    ASSERT_EQ(pos, std::get<0>(e));
+    ASSERT_GT(std::get<2>(e), 0UL);
+    if (std::get<3>(e)) {
+      ASSERT_EQ(ms[pos].ptr, std::get<1>(e));
+      ASSERT_LE(std::get<2>(e), ms[pos].len);
+    }
+    pos += std::get<2>(e);
+  }
+  ASSERT_EQ(ms.size(), pos);
+}
+
+TEST(RlzapOptimalParse, NotWorseThanGreedy)
+{
+  for (auto mutation : { 0.001, 0.01, 0.05, 0.2 }) {
+    auto ms = random_ms(300UL, 1500UL, mutation, 2UL);
+    Parser optimal { 4UL, rlz::optimal::bit_cost{4UL, 32UL, 2UL, 4UL} };
+    auto opt    = cost(optimal, run(optimal, ms), ms);
+    auto greedy = cost(optimal, run(rlz::parser_rlzap{4UL, 32UL, 2UL}, ms), ms);
+    ASSERT_LE(opt, greedy + 1e-6) << "Mutation rate " << mutation;
+  }
+}
+
+TEST(RlzapOptimalParse, PhrasePenalty)
+{
+  auto ms = random_ms(300UL, 1500UL, 0.05, 3UL);
+  auto copies = [&ms] (double penalty) {
+    auto events = run(Parser{4UL, rlz::optimal::bit_cost{4UL, 32UL, 2UL, 4UL, penalty}}, ms);
+    return std::count_if(events.begin(), events.end(), [] (const event &e) { return std::get<3>(e); });
+  };
+  ASSERT_LE(copies(64.0), copies(0.0));
+}
+
+TEST(RlzapOptimalParse, Unmatched)
+{
+  std::vector<rlz::match> ms(20UL);
+  auto events = run(Parser{}, ms);
+  ASSERT_EQ(1UL, events.size());
+  ASSERT_EQ(std::make_tuple(0UL, 0UL, 20UL, false), events.front());
+}
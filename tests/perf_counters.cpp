@@ -0,0 +1,52 @@
+#include <perf_counters.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "main.hpp"
+
+using namespace rlz::perf;
+
+TEST(PerfSummary, Percentiles)
+{
+  std::vector<double> values;
+  for (auto i = 1000U; i > 0U; --i) {
+    values.push_back(i);
+  }
+  summary s(values);
+  ASSERT_EQ(1000UL, s.samples);
+  ASSERT_DOUBLE_EQ(500.5, s.mean);
+  ASSERT_DOUBLE_EQ(1.0, s.min);
+  ASSERT_DOUBLE_EQ(1000.0, s.max);
+  ASSERT_DOUBLE_EQ(500.0, s.at(50.0));
+  ASSERT_DOUBLE_EQ(900.0, s.at(90.0));
+  ASSERT_DOUBLE_EQ(990.0, s.at(99.0));
+  ASSERT_DOUBLE_EQ(999.0, s.at(99.9));
+}
+
+TEST(PerfSummary, Empty)
+{
+  summary s(std::vector<double>{});
+  ASSERT_EQ(0UL, s.samples);
+  ASSERT_TRUE(s.percentiles.empty());
+}
+
+TEST(PerfCounters, StartStop)
+{
+  // Counters may be unavailable (containers, perf_event_paranoid): only check consistency
+  counters c;
+  c.start();
+  volatile std::uint64_t sum = 0UL;
+  for (auto i = 0U; i < 100000U; ++i) {
+    sum += i;
+  }
+  c.stop();
+  auto values = c.values();
+  ASSERT_EQ(c.available(), not values.empty());
+  for (auto &v : values) {
+    if (std::string(v.name) == "instructions") {
+      ASSERT_GT(v.count, 0UL);
+    }
+  }
+}
@@ -0,0 +1,152 @@
+#include <alphabet.hpp>
+#include <api.hpp>
+#include <containers.hpp>
+#include <dumper.hpp>
+#include <get_matchings.hpp>
+#include <parse_rlzap.hpp>
+#include <rereference.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "main.hpp"
+
+using namespace rlz;
+
+using Alphabet = alphabet::dna<>;
+using Parse    = api::ParseKeeper<values::Size<32UL>, values::Size<4UL>>;
+using Literal  = api::LiteralKeeper<prefix::sampling_cumulative<values::Size<4UL>, values::Size<64UL>>>;
+using Iterator = std::vector<char>::iterator;
+using Source   = iterator_container<Alphabet, Iterator>;
+using Index    = impl::Index<Alphabet, container_wrapper<Alphabet, Source>, Parse, Literal>;
+using Block    = reference_map::block;
+
+class Rereference : public ::testing::Test {
+public:
+  std::vector<char> old_reference;
+  std::vector<char> new_reference;
+  std::vector<char> input;
+  std::vector<Block> blocks;
+
+  void SetUp() override
+  {
+    std::default_random_engine rg(7);
+    std::uniform_int_distribution<int> base(0, 3);
+    std::bernoulli_distribution mutate(0.02);
+    const char bases[] = { 'A', 'C', 'G', 'T' };
+    auto random_base = [&] () { return bases[base(rg)]; };
+
+    old_reference.resize(3000UL);
+    for (auto &s : old_reference) {
+      s = random_base();
+    }
+    for (auto c = 0UL; c < 4UL; ++c) {
+      for (auto s : old_reference) {
+        input.push_back(mutate(rg) ? random_base() : s);
+      }
+    }
+
+    // New version: 50 symbols inserted at 1000, [2000, 2100) replaced
+    new_reference.assign(old_reference.begin(), std::next(old_reference.begin(), 1000UL));
+    for (auto i = 0UL; i < 50UL; ++i) {
+      new_reference.push_back(random_base());
+    }
+    new_reference.insert(new_reference.end(), std::next(old_reference.begin(), 1000UL), std::next(old_reference.begin(), 2000UL));
+    for (auto i = 0UL; i < 100UL; ++i) {
+      new_reference.push_back(random_base());
+    }
+    new_reference.insert(new_reference.end(), std::next(old_reference.begin(), 2100UL), old_reference.end());
+    blocks = {{ Block{0UL, 0UL, 1000UL}, Block{1000UL, 1050UL, 1000UL}, Block{2100UL, 2150UL, 900UL} }};
+  }
+
+  Index build(std::vector<char> &reference, build::phrase_bounds bounds = build::phrase_bounds())
+  {
+    auto ref_dump   = utils::get_iterator_dumper(reference.begin(), reference.end());
+    auto input_dump = utils::get_iterator_dumper(input.begin(), input.end());
+    auto matches    = std::get<0>(get_relative_matches<Alphabet>(ref_dump, input_dump));
+    return construct_ptr<Alphabet, Parse, Literal>(
+      input.data(), Source(reference.begin(), reference.end()), parser_rlzap{4UL, 32UL, 2UL},
+      matches.begin(), matches.end(), bounds
+    );
+  }
+};
+
+TEST_F(Rereference, Map)
+{
+  reference_map map(blocks.begin(), blocks.end());
+  EXPECT_EQ(2900UL, map.mapped());
+  size_t to = 0UL;
+  EXPECT_TRUE(map.translate(0UL, 1000UL, to));
+  EXPECT_EQ(0UL, to);
+  EXPECT_TRUE(map.translate(1500UL, 10UL, to));
+  EXPECT_EQ(1550UL, to);
+  EXPECT_FALSE(map.translate(990UL, 20UL, to));
+  EXPECT_FALSE(map.translate(2050UL, 1UL, to));
+  EXPECT_NO_THROW(map.verify(old_reference, new_reference));
+
+  std::stringstream text("0 0 1000\n1000 1050 1000\n2100 2150 900\n");
+  auto loaded = reference_map::load(text);
+  EXPECT_TRUE(loaded.translate(2999UL, 1UL, to));
+  EXPECT_EQ(3049UL, to);
+
+  std::vector<Block> overlapping {{ Block{0UL, 0UL, 100UL}, Block{50UL, 200UL, 10UL} }};
+  EXPECT_THROW(reference_map(overlapping.begin(), overlapping.end()), std::logic_error);
+  std::vector<Block> wrong {{ Block{0UL, 1000UL, 100UL} }};
+  EXPECT_THROW(reference_map(wrong.begin(), wrong.end()).verify(old_reference, new_reference), std::logic_error);
+}
+
+TEST_F(Rereference, Translates)
+{
+  auto old_idx = build(old_reference);
+  reference_map map(blocks.begin(), blocks.end());
+  reference_matcher<Alphabet> matcher(new_reference.begin(), new_reference.end());
+
+  size_t reparsed = 0UL;
+  auto idx = rereference(
+    old_idx, container_wrapper<Alphabet, Source>(Source(new_reference.begin(), new_reference.end())),
+    map, matcher, parser_rlzap{4UL, 32UL, 2UL}, &reparsed
+  );
+  ASSERT_EQ(input.size(), idx.size());
+  auto output = idx(0UL, idx.size());
+  EXPECT_TRUE(std::equal(input.begin(), input.end(), output.begin()));
+  EXPECT_GT(reparsed, 0UL);
+  EXPECT_LT(reparsed, input.size() / 4UL);
+
+  // Close to a fresh build against the new reference
+  auto fresh = build(new_reference);
+  auto size = sdsl::size_in_bytes(idx), fresh_size = sdsl::size_in_bytes(fresh);
+  EXPECT_LE(size, fresh_size * 11UL / 10UL) << "Rereferenced " << size << " bytes, fresh " << fresh_size;
+}
+
+TEST_F(Rereference, Bounds)
+{
+  const build::phrase_bounds bounds(0UL, 256UL);
+  auto old_idx = build(old_reference, bounds);
+  reference_map map(blocks.begin(), blocks.end());
+  reference_matcher<Alphabet> matcher(new_reference.begin(), new_reference.end());
+
+  auto idx = rereference(
+    old_idx, container_wrapper<Alphabet, Source>(Source(new_reference.begin(), new_reference.end())),
+    map, matcher, parser_rlzap{4UL, 32UL, 2UL}, nullptr, bounds
+  );
+  auto output = idx(0UL, idx.size());
+  ASSERT_TRUE(std::equal(input.begin(), input.end(), output.begin()));
+
+  // Reparsed runs too start blocks at the multiples of the block length of the whole input
+  std::vector<size_t> starts;
+  auto start = 0UL;
+  auto visit = [&] (std::int64_t, size_t phrase_len, size_t, Index::LiteralIterator, bool block) {
+    if (block) {
+      starts.push_back(start);
+    }
+    start += phrase_len;
+  };
+  idx.process_subphrases(visit);
+  for (auto p = 0UL; p < input.size(); p += bounds.block_len) {
+    EXPECT_TRUE(std::binary_search(starts.begin(), starts.end(), p)) << "No block at " << p;
+  }
+}
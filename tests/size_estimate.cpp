@@ -0,0 +1,166 @@
+#include <alphabet.hpp>
+#include <api.hpp>
+#include <containers.hpp>
+#include <dumper.hpp>
+#include <get_matchings.hpp>
+#include <parse_rlzap.hpp>
+#include <size_estimate.hpp>
+
+#include <random>
+#include <vector>
+
+#include <sdsl/io.hpp>
+
+#include "main.hpp"
+
+using namespace rlz;
+
+template <typename AlphabetType, size_t Diff, size_t Lit, size_t Sample>
+struct config {
+  using Alphabet = AlphabetType;
+  using Parse    = api::ParseKeeper<values::Size<32UL>, values::Size<Diff>>;
+  using Literal  = api::LiteralKeeper<prefix::sampling_cumulative<values::Size<Lit>, values::Size<Sample>>>;
+  static constexpr size_t diff   = Diff;
+  static constexpr size_t lit    = Lit;
+  static constexpr size_t sample = Sample;
+};
+
+template <typename A, size_t D, size_t L, size_t S> constexpr size_t config<A, D, L, S>::diff;
+template <typename A, size_t D, size_t L, size_t S> constexpr size_t config<A, D, L, S>::lit;
+template <typename A, size_t D, size_t L, size_t S> constexpr size_t config<A, D, L, S>::sample;
+
+// Reference, and an input made of mutated copies of it: long enough for the pointer vectors to grow
+template <typename Symbol>
+std::tuple<std::vector<Symbol>, std::vector<Symbol>> generate(size_t ref_len, size_t copies, double mutation)
+{
+  std::default_random_engine rg(42);
+  std::uniform_int_distribution<int> base(0, 3);
+  std::bernoulli_distribution mutate(mutation);
+  const Symbol bases[] = { 'A', 'C', 'G', 'T' };
+  std::vector<Symbol> ref(ref_len), input;
+  for (auto &s : ref) {
+    s = bases[base(rg)];
+  }
+  for (auto c = 0UL; c < copies; ++c) {
+    for (auto i = 0UL; i < ref.size(); ++i) {
+      if (mutate(rg)) {
+        auto run = 1 + base(rg) * 7;   // Runs longer than short literal lengths
+        for (auto j = 0; j < run; ++j) {
+          input.push_back(bases[base(rg)]);
+        }
+        i += base(rg) * 50;             // Shifts pointers by more than small DiffSizes
+      } else {
+        input.push_back(ref[i]);
+      }
+    }
+  }
+  return std::make_tuple(ref, input);
+}
+
+template <typename Config>
+class SizeEstimate : public ::testing::Test { };
+
+using SizeEstimateTypes = ::testing::Types<
+  config<alphabet::dna<>, 2UL, 2UL, 16UL>,
+  config<alphabet::dna<>, 4UL, 4UL, 64UL>,
+  config<alphabet::dna<>, 8UL, 8UL, 32UL>,
+  config<alphabet::lcp_32, 2UL, 8UL, 48UL>,
+  config<alphabet::lcp_32, 8UL, 2UL, 16UL>,
+  config<alphabet::Integer<16UL>, 4UL, 2UL, 64UL>
+>;
+TYPED_TEST_CASE(SizeEstimate, SizeEstimateTypes);
+
+TYPED_TEST(SizeEstimate, MatchesIndex)
+{
+  using Alphabet = typename TypeParam::Alphabet;
+  using Symbol   = typename Alphabet::Symbol;
+  using Iterator = typename std::vector<Symbol>::iterator;
+
+  for (auto mutation : { 0.001, 0.01, 0.1 }) {
+    std::vector<Symbol> ref, input;
+    std::tie(ref, input) = generate<Symbol>(5000UL, 8UL, mutation);
+
+    std::vector<rlz::match> matches;
+    {
+      auto ref_dump   = rlz::utils::get_iterator_dumper(ref.begin(), ref.end());
+      auto input_dump = rlz::utils::get_iterator_dumper(input.begin(), input.end());
+      matches = std::get<0>(rlz::get_relative_matches<Alphabet>(ref_dump, input_dump));
+    }
+    rlz::parser_rlzap parser { TypeParam::diff, 32UL, 2UL };
+
+    iterator_container<Alphabet, Iterator> ref_cont(ref.begin(), ref.end());
+    auto index = construct_ptr<Alphabet, typename TypeParam::Parse, typename TypeParam::Literal>(
+      input.data(), ref_cont, parser, matches.begin(), matches.end()
+    );
+    auto sizes = estimate_sizes<Alphabet>(
+      input.data(), ref.size(), parser, matches.begin(), matches.end(),
+      { 2UL, TypeParam::diff }, { TypeParam::lit }, { TypeParam::sample }
+    );
+    ASSERT_EQ(sizes.size(), 2UL);
+    auto &est = sizes.back();
+    EXPECT_EQ(est.diff_bits, TypeParam::diff);
+    EXPECT_EQ(est.lit_bits, TypeParam::lit);
+    EXPECT_EQ(est.sample, TypeParam::sample);
+
+    sdsl::nullstream ns;
+    EXPECT_EQ(est.parse(), index.serialize_parse(ns));
+    EXPECT_EQ(est.literal(), index.serialize_literals(ns));
+    EXPECT_EQ(est.total(), sdsl::size_in_bytes(index));
+  }
+}
+
+TEST(SizeEstimate, Counts)
+{
+  using Alphabet = alphabet::dna<>;
+  std::vector<char> text(100UL, 'A');
+  size_estimator<Alphabet> est(text.data(), { 2UL, 8UL }, { 2UL, 4UL });
+  est.literal_evt(0UL, 7UL);          // Opens the first block
+  est.copy_evt(7UL, 307UL, 10UL);     // Delta 300: new block for both
+  est.literal_evt(17UL, 20UL);
+  est.copy_evt(37UL, 340UL, 5UL);     // Delta 303: relative with 8 bits only
+  est.copy_evt(42UL, 344UL, 58UL);    // Delta 302
+  est.end_evt();
+  EXPECT_EQ(est.parsed_length(), 100UL);
+
+  auto sizes = est.sizes({ 16UL });
+  ASSERT_EQ(sizes.size(), 4UL);
+  // Literal lengths of 2 bits: 3 + (1 + 6) + 1 + 1 subphrases
+  EXPECT_EQ(sizes[0].diff_bits, 2UL);
+  EXPECT_EQ(sizes[0].subphrases, 12UL);
+  EXPECT_EQ(sizes[0].blocks, 3UL);
+  EXPECT_EQ(sizes[1].diff_bits, 8UL);
+  EXPECT_EQ(sizes[1].blocks, 2UL);
+  // Literal lengths of 4 bits: 1 + (1 + 1) + 1 + 1 subphrases
+  EXPECT_EQ(sizes[2].subphrases, 5UL);
+  EXPECT_EQ(sizes[3].subphrases, 5UL);
+  EXPECT_EQ(sizes[2].literals, sizes[0].literals);
+}
+
+TEST(SizeEstimate, Origin)
+{
+  // The parse of Counts, as a part of a longer input starting at 1000 with the same deltas
+  using Alphabet = alphabet::dna<>;
+  std::vector<char> text(100UL, 'A');
+  auto parse = [&] (size_estimator<Alphabet> &est, size_t origin) {
+    est.literal_evt(origin, 7UL);
+    est.copy_evt(origin + 7UL, origin + 307UL, 10UL);
+    est.literal_evt(origin + 17UL, 20UL);
+    est.copy_evt(origin + 37UL, origin + 340UL, 5UL);
+    est.copy_evt(origin + 42UL, origin + 344UL, 58UL);
+    est.end_evt();
+  };
+  size_estimator<Alphabet> whole(text.data(), { 2UL, 8UL }, { 2UL, 4UL });
+  size_estimator<Alphabet> part(text.data(), { 2UL, 8UL }, { 2UL, 4UL }, 1000UL);
+  parse(whole, 0UL);
+  parse(part, 1000UL);
+  EXPECT_EQ(part.parsed_length(), 100UL);
+
+  auto expected = whole.sizes({ 16UL }), sizes = part.sizes({ 16UL });
+  ASSERT_EQ(expected.size(), sizes.size());
+  for (auto i = 0UL; i < sizes.size(); ++i) {
+    EXPECT_EQ(expected[i].blocks, sizes[i].blocks);
+    EXPECT_EQ(expected[i].subphrases, sizes[i].subphrases);
+    EXPECT_EQ(expected[i].parse(), sizes[i].parse());
+    EXPECT_EQ(expected[i].literal(), sizes[i].literal());
+  }
+}